@@ -0,0 +1,205 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_CLAUSEEXCHANGE_H
+
+#include "satBasicDef.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_set>
+#include <vector>
+
+// Learned clauses passed between the workers of a portfolio, without locks.
+//
+// Every worker publishes into its own ring of 32-bit words and reads the
+// rings of the others, each from its own cursor. A clause is a header word
+// (size, then LBD in the upper bits) and its literal codes. The writer never
+// waits: a reader that falls a full ring behind loses the clauses in between.
+// Words are claimed through head before they are written and published
+// through tail after, so a reader checks head once it has copied a clause to
+// know the writer did not reuse the words meanwhile (a seqlock).
+//
+// A clause is only published or delivered once per worker: hashes of the
+// clauses a worker already sent or received filter the duplicates.
+class ClauseExchange {
+
+public:
+
+    // Longer clauses are not worth the traffic
+    static constexpr uint32_t MAX_SIZE = 255;
+
+private:
+
+    class Ring {
+
+    public:
+
+        const uint64_t mask;
+
+        std::unique_ptr<std::atomic<uint32_t>[]> words;
+
+        // Words claimed and words published by the writer, apart so that
+        // the readers polling tail do not share the writer's line
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+
+        // capacity: a power of two
+        explicit Ring(uint64_t capacity)
+                : mask(capacity - 1), words(new std::atomic<uint32_t>[capacity]), head(0), tail(0) {
+
+            for (uint64_t i = 0; i < capacity; ++i)
+                words[i].store(0, std::memory_order_relaxed);
+        }
+    };
+
+    // State of one worker as a reader, only ever touched by that worker
+    struct alignas(64) Reader {
+
+        std::vector<uint64_t>        cursors;
+        std::unordered_set<uint64_t> seen;
+        std::vector<L>               clause;
+    };
+
+    // Past this many hashes a worker forgets them, duplicates are then only
+    // filtered for the recent clauses
+    static constexpr size_t MAX_SEEN = 1 << 20;
+
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::vector<Reader>                readers;
+
+    // Order independent: the literal codes are sorted first
+    [[nodiscard]] static uint64_t hash(std::vector<uint32_t>& codes) {
+
+        std::sort(codes.begin(), codes.end());
+
+        uint64_t h = 0xcbf29ce484222325ULL ^ codes.size();
+
+        for (uint32_t x: codes) {
+
+            h ^= x;
+            h *= 0x100000001b3ULL;
+            h ^= h >> 29;
+        }
+
+        return h;
+    }
+
+    // False if the worker already had the clause
+    [[nodiscard]] static bool firstTime(Reader& r, const L* begin, const L* end) {
+
+        std::vector<uint32_t> codes;
+
+        codes.reserve(end - begin);
+
+        for (const L* l = begin; l != end; ++l)
+            codes.push_back(l->index());
+
+        if (r.seen.size() >= MAX_SEEN)
+            r.seen.clear();
+
+        return r.seen.insert(hash(codes)).second;
+    }
+
+public:
+
+    // capacity: words per ring, rounded up to a power of two
+    explicit ClauseExchange(size_t workers, uint64_t capacity = 1 << 16) : readers(workers) {
+
+        uint64_t words = 1;
+
+        while (words < capacity)
+            words <<= 1;
+
+        for (size_t i = 0; i < workers; ++i) {
+
+            rings.push_back(std::make_unique<Ring>(words));
+
+            readers[i].cursors = std::vector<uint64_t>(workers, 0);
+        }
+    }
+
+    ClauseExchange(const ClauseExchange&) = delete;
+    ClauseExchange& operator = (const ClauseExchange&) = delete;
+
+    // Offer a clause of worker from to the others, false if it was dropped
+    // as too long or as a duplicate
+    bool publish(size_t from, const L* begin, const L* end, uint32_t lbd) {
+
+        auto size = (uint32_t)(end - begin);
+
+        if (size == 0 || size > MAX_SIZE || not firstTime(readers[from], begin, end))
+            return false;
+
+        Ring& ring = *rings[from];
+
+        uint64_t w = ring.head.load(std::memory_order_relaxed);
+
+        ring.head.store(w + size + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        ring.words[w & ring.mask].store(size | std::min<uint32_t>(lbd, 0xffffff) << 8, std::memory_order_relaxed);
+
+        for (uint32_t k = 0; k < size; ++k)
+            ring.words[(w + 1 + k) & ring.mask].store(begin[k].index(), std::memory_order_relaxed);
+
+        ring.tail.store(w + size + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    // Calls f(begin, end, lbd) on every clause published by the others since
+    // the last call of worker to, which has not seen it yet
+    template <class F>
+    void collect(size_t to, F f) {
+
+        Reader& r = readers[to];
+
+        for (size_t from = 0; from < rings.size(); ++from) {
+
+            if (from == to)
+                continue;
+
+            Ring&     ring   = *rings[from];
+            uint64_t& cursor = r.cursors[from];
+
+            uint64_t tail = ring.tail.load(std::memory_order_acquire);
+
+            // Lapped: whatever was behind is gone
+            if (tail - cursor > ring.mask + 1)
+                cursor = tail;
+
+            while (cursor < tail) {
+
+                uint32_t header = ring.words[cursor & ring.mask].load(std::memory_order_relaxed);
+                uint32_t size   = header & 0xff;
+
+                r.clause.clear();
+
+                for (uint32_t k = 0; k < size; ++k)
+                    r.clause.push_back(L::fromIndex(
+                            ring.words[(cursor + 1 + k) & ring.mask].load(std::memory_order_relaxed)));
+
+                // The writer claimed these words again while they were copied
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (ring.head.load(std::memory_order_relaxed) - cursor > ring.mask + 1) {
+
+                    cursor = tail;
+                    break;
+                }
+
+                cursor += size + 1;
+
+                if (size != 0 && firstTime(r, r.clause.data(), r.clause.data() + size))
+                    f(r.clause.data(), r.clause.data() + size, header >> 8);
+            }
+        }
+    }
+};
+
+#define LI_SAT_SOLVER_CLAUSEEXCHANGE_H
+
+#endif //LI_SAT_SOLVER_CLAUSEEXCHANGE_H
@@ -0,0 +1,133 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_CLAUSEKIND_H
+
+#include "satBasicDef.h"
+#include "../common/ClauseArena.h"
+#include <vector>
+
+// Clauses are stored by kind, each one with its own propagation kernel:
+//
+//   BINARY:  no storage, each literal is in the watch list of the other one
+//   TERNARY: three literals in a row of the TernaryStore, the watch lists hold
+//            the two other literals so propagation never leaves them
+//   LONG:    the clause arena, two watched literals
+enum ClauseKind : uint32_t {
+    BINARY,
+    TERNARY,
+    LONG
+};
+
+// Reference to a ternary clause: its row in the TernaryStore
+typedef uint32_t TRef;
+
+// Original ternary clauses, three literals per row and no header
+class TernaryStore {
+
+private:
+
+    std::vector<L> lits;
+
+public:
+
+    TRef add(L a, L b, L c) {
+
+        auto t = (TRef)(lits.size() / 3);
+
+        lits.push_back(a);
+        lits.push_back(b);
+        lits.push_back(c);
+
+        return t;
+    }
+
+    [[nodiscard]] inline const L* begin(TRef t) const {
+
+        return &lits[3 * (size_t)t];
+    }
+
+    [[nodiscard]] inline const L* end(TRef t) const {
+
+        return begin(t) + 3;
+    }
+
+    [[nodiscard]] inline TRef size() const {
+
+        return (TRef)(lits.size() / 3);
+    }
+};
+
+// Why a variable was assigned: nothing (decisions and level 0), or a clause
+// of some kind. A binary reason holds the other literal of the clause.
+class Reason {
+
+private:
+
+    static constexpr uint32_t NONE = 3;
+
+    uint32_t kind_;
+    uint32_t ref;
+
+    inline Reason(uint32_t kind, uint32_t ref) : kind_(kind), ref(ref) {}
+
+public:
+
+    inline Reason() : kind_(NONE), ref(0) {}
+
+    [[nodiscard]] inline static Reason binary(L other) {
+
+        return Reason(BINARY, other.index());
+    }
+
+    [[nodiscard]] inline static Reason ternary(TRef t) {
+
+        return Reason(TERNARY, t);
+    }
+
+    [[nodiscard]] inline static Reason clause(CRef cr) {
+
+        return Reason(LONG, cr);
+    }
+
+    [[nodiscard]] inline bool none() const {
+
+        return kind_ == NONE;
+    }
+
+    [[nodiscard]] inline ClauseKind kind() const {
+
+        return (ClauseKind)kind_;
+    }
+
+    [[nodiscard]] inline L other() const {
+
+        return L::fromIndex(ref);
+    }
+
+    [[nodiscard]] inline TRef tref() const {
+
+        return ref;
+    }
+
+    [[nodiscard]] inline CRef cref() const {
+
+        return ref;
+    }
+
+    // Only valid for LONG reasons, after a garbage collection
+    inline void setCRef(CRef cr) {
+
+        ref = cr;
+    }
+
+    [[nodiscard]] inline bool isClause(CRef cr) const {
+
+        return kind_ == LONG && ref == cr;
+    }
+};
+
+#define LI_SAT_SOLVER_CLAUSEKIND_H
+
+#endif //LI_SAT_SOLVER_CLAUSEKIND_H
@@ -0,0 +1,348 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_CUBEANDCONQUER_H
+
+#include "Problem.h"
+#include "ClauseExchange.h"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Cubes waiting for a worker: one deque per worker, the owner takes from
+// the back, idle workers steal from the front of the others. pending counts
+// the cubes not solved yet, queued or running: at 0 every cube is refuted.
+class CubeQueue {
+
+public:
+
+    typedef std::vector<L> Cube;
+
+private:
+
+    struct alignas(64) Deque {
+
+        std::mutex       lock;
+        std::deque<Cube> cubes;
+    };
+
+    std::vector<Deque> deques;
+
+    std::atomic<size_t> pending;
+
+    // Workers that found nothing to take
+    std::atomic<size_t> idle;
+
+public:
+
+    explicit CubeQueue(size_t workers) : deques(workers), pending(0), idle(0) {}
+
+    void push(size_t worker, Cube cube) {
+
+        pending.fetch_add(1);
+
+        std::lock_guard<std::mutex> guard(deques[worker].lock);
+
+        deques[worker].cubes.push_back(std::move(cube));
+    }
+
+    // Own cubes last in first out, then the oldest cube of another worker
+    bool take(size_t worker, Cube& cube) {
+
+        for (size_t k = 0; k < deques.size(); ++k) {
+
+            Deque& d = deques[(worker + k) % deques.size()];
+
+            std::lock_guard<std::mutex> guard(d.lock);
+
+            if (d.cubes.empty())
+                continue;
+
+            if (k == 0) {
+
+                cube = std::move(d.cubes.back());
+                d.cubes.pop_back();
+            }
+            else {
+
+                cube = std::move(d.cubes.front());
+                d.cubes.pop_front();
+            }
+
+            return true;
+        }
+
+        return false;
+    }
+
+    // A cube taken is solved or replaced by its two halves
+    inline void done() {
+
+        pending.fetch_sub(1);
+    }
+
+    [[nodiscard]] inline bool empty() const {
+
+        return pending.load() == 0;
+    }
+
+    inline void setIdle(bool on) {
+
+        if (on)
+            idle.fetch_add(1);
+        else
+            idle.fetch_sub(1);
+    }
+
+    [[nodiscard]] inline bool anyIdle() const {
+
+        return idle.load(std::memory_order_relaxed) != 0;
+    }
+};
+
+// Cube and conquer: a lookahead cuber splits the formula into cubes, sets
+// of decisions, and a pool of CDCL workers solves the formula under each
+// cube as assumptions. The formula is unsatisfiable once every cube is
+// refuted, and satisfiable as soon as a worker finds a model.
+//
+// A worker runs a cube for a conflict budget at a time. When the budget
+// runs out while another worker is idle, it splits the cube with one more
+// lookahead decision and keeps a half, the idle one steals the other.
+// Workers keep their learned clauses from a cube to the next, and share
+// the short ones as in the portfolio.
+class CubeAndConquer {
+
+public:
+
+    // One line per cube solved
+    struct CubeReport {
+
+        CubeQueue::Cube cube;
+        size_t          worker;
+        Result          result;
+        double          ms;
+        uint64_t        conflicts;
+
+        // The budget ran out and the cube was split instead
+        bool split;
+    };
+
+private:
+
+    const Formula& formula;
+
+    ProblemConfig config;
+
+    size_t workers;
+
+    // Decisions of the first cubes
+    uint32_t depth;
+
+    // Conflicts of a cube between two looks at the idle workers
+    uint64_t budget;
+
+    CubeQueue queue;
+
+    // One ring per worker, and one for the cuber
+    ClauseExchange exchange;
+
+    std::atomic<bool> stop;
+    std::atomic<int>  answer;
+
+    std::vector<std::vector<CubeReport>> reports;
+
+    void found(Result res) {
+
+        int none = UNKNOWN;
+
+        answer.compare_exchange_strong(none, res);
+        stop.store(true);
+    }
+
+    // Depth first lookahead to the given depth, refuted cubes are dropped.
+    // The cubes go round robin to the workers.
+    void makeCubes() {
+
+        Problem cuber = Problem(formula, config);
+
+        cuber.share(exchange, workers);
+
+        // A short search first, walks included: satisfiable instances often end here
+        Result quick = cuber.solve(std::vector<L>(), budget);
+
+        if (quick != UNKNOWN) {
+
+            found(quick);
+            return;
+        }
+
+        std::vector<CubeQueue::Cube> open = std::vector<CubeQueue::Cube>(1);
+
+        size_t next = 0;
+
+        while (not open.empty()) {
+
+            CubeQueue::Cube cube = std::move(open.back());
+            open.pop_back();
+
+            if (cube.size() >= depth) {
+
+                queue.push(next++ % workers, std::move(cube));
+                continue;
+            }
+
+            L      best = L(0, UNDEF);
+            Result res = cuber.branch(cube, best);
+
+            if (res == SATISFIABLE || cuber.isUnsat()) {
+
+                found(res);
+                return;
+            }
+
+            if (res == UNSATISFIABLE)
+                continue;
+
+            cube.push_back(best);
+
+            CubeQueue::Cube other = cube;
+
+            other.back().reverse();
+
+            open.push_back(std::move(other));
+            open.push_back(std::move(cube));
+        }
+    }
+
+    void work(size_t id) {
+
+        Problem problem = Problem(formula, config);
+
+        problem.interruptOn(stop);
+        problem.share(exchange, id);
+
+        CubeQueue::Cube cube;
+
+        while (not stop.load()) {
+
+            if (not queue.take(id, cube)) {
+
+                // Every cube refuted
+                if (queue.empty())
+                    return;
+
+                queue.setIdle(true);
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+                queue.setIdle(false);
+
+                continue;
+            }
+
+            auto     start = std::chrono::steady_clock::now();
+            uint64_t from  = problem.getConflicts();
+
+            Result res;
+
+            // Keep going while nobody waits for work
+            do
+                res = problem.solve(cube, budget);
+            while (res == UNKNOWN && not stop.load() && not queue.anyIdle());
+
+            bool split = false;
+
+            if (res == UNKNOWN && not stop.load()) {
+
+                L best = L(0, UNDEF);
+
+                res = problem.branch(cube, best);
+
+                if (res == UNKNOWN) {
+
+                    CubeQueue::Cube other = cube;
+
+                    other.push_back(best);
+                    other.back().reverse();
+
+                    queue.push(id, std::move(other));
+
+                    cube.push_back(best);
+                    queue.push(id, cube);
+                    cube.pop_back();
+
+                    split = true;
+                }
+            }
+
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+            reports[id].push_back({cube, id, res, ms, problem.getConflicts() - from, split});
+
+            if (res == SATISFIABLE || problem.isUnsat())
+                found(res);
+
+            queue.done();
+        }
+    }
+
+public:
+
+    // depth: decisions per initial cube, 0 to have about 8 cubes per worker
+    CubeAndConquer(const Formula& formula, const ProblemConfig& config, size_t workers, uint32_t depth,
+                   uint64_t budget)
+            : formula(formula), config(config), workers(workers), depth(depth), budget(budget), queue(workers),
+              exchange(workers + 1), stop(false), answer(UNKNOWN), reports(workers) {
+
+        if (this->depth == 0)
+            while ((size_t)1 << this->depth < 8 * workers)
+                ++this->depth;
+    }
+
+    Result solve() {
+
+        makeCubes();
+
+        if (stop.load())
+            return (Result)answer.load();
+
+        std::vector<std::thread> threads;
+
+        for (size_t i = 0; i < workers; ++i)
+            threads.emplace_back([this, i] () { work(i); });
+
+        for (std::thread& t: threads)
+            t.join();
+
+        // No model under any cube
+        if (answer.load() == UNKNOWN)
+            return UNSATISFIABLE;
+
+        return (Result)answer.load();
+    }
+
+    // Per cube: literals (DIMACS), worker, outcome, time and conflicts, as comment lines
+    void printReport(std::ostream& os) const {
+
+        static const char* names[] = {"unknown", "sat", "unsat"};
+
+        for (const std::vector<CubeReport>& rs: reports)
+            for (const CubeReport& r: rs) {
+
+                os << "c cube";
+
+                for (const L& l: r.cube)
+                    os << ' ' << (l.getSt() == TRUE ? (int)l.getId() + 1 : -(int)l.getId() - 1);
+
+                os << " | worker " << r.worker << ' ' << (r.split ? "split" : names[r.result]) << ' '
+                   << r.ms << " ms " << r.conflicts << " conflicts" << std::endl;
+            }
+    }
+};
+
+#define LI_SAT_SOLVER_CUBEANDCONQUER_H
+
+#endif //LI_SAT_SOLVER_CUBEANDCONQUER_H
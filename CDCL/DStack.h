@@ -5,215 +5,421 @@
 #ifndef LI_SAT_SOLVER_DSTACK_H
 
 #include "satBasicDef.h"
+#include "ClauseKind.h"
+#include "VarHeap.h"
+#include "../common/ClauseArena.h"
+#include "../common/Phase.h"
 #include <algorithm>
+#include <utility>
 #include <vector>
-#include <queue>
-#include <stack>
-#include <set>
-
-#include <iostream>
 
 class DStack {
 
+public:
+
+    typedef ClauseArena<L> Arena;
+
 private:
 
-    class DepNode {
+    // Assignments in chronological order, trailLim[d] is where level d + 1 starts
+    std::vector<L>      trail;
+    std::vector<size_t> trailLim;
 
-    private:
+    // Next trail position to propagate
+    size_t qhead;
 
-        std::vector<LID> deps;
+    // Per variable: implying clause (none for decisions and level 0) and level
+    std::vector<Reason>   reason;
+    std::vector<uint32_t> levels;
+    std::vector<LST>      model;
+
+    // Unassigned variables by activity, bumped during conflict analysis
+    VarHeap order;
 
-    public:
+    // Polarity of the next decision on each variable
+    Phases phases;
 
-        inline explicit DepNode(const std::vector<LID>& cause) : deps(cause) {}
+    // Scratch for conflict analysis
+    std::vector<char> seen;
 
-        inline static void recGen(std::set<L>& acc, DStack& root, LID id) {
+    // Scratch for LBD computation, one stamp per level
+    std::vector<uint64_t> levelStamp;
+    uint64_t              stamp;
 
-            //std::cout << id << ":";
+    // LBD of the last clause returned by popConflict()
+    uint32_t learntLbd;
 
-            acc.insert(*root.ind[id]);
+    inline void assign(LID id, LST st, Reason cause) {
 
-            if (root.depTree[id] == nullptr)
-                return;
+        model[id]  = st;
+        reason[id] = cause;
+        levels[id] = level();
 
-            for (LID i: root.depTree[id]->deps)
-                recGen(acc, root,i);
+        trail.emplace_back(id, st);
+    }
+
+    // Literals of the clause behind r. A binary reason only yields its other
+    // literal, the implied one is left out, so other must outlive the range.
+    [[nodiscard]] static inline std::pair<const L*, const L*> lits(const Arena& ca, const TernaryStore& tern,
+                                                                  const Reason& r, L& other) {
+
+        switch (r.kind()) {
+
+            case BINARY:
+                other = r.other();
+                return {&other, &other + 1};
+            case TERNARY:
+                return {tern.begin(r.tref()), tern.end(r.tref())};
+            default:
+                return {ca.begin(r.cref()), ca.end(r.cref())};
         }
-    };
+    }
 
-    class Decision {
+    // A literal is redundant when every other literal of its reason is already in the clause
+    [[nodiscard]] bool redundant(const Arena& ca, const TernaryStore& tern, LID id) const {
 
-    private:
+        if (reason[id].none())
+            return false;
 
-        DStack&        root;
-        L              deci;
-        std::vector<L> prop;
+        L other = L(0, UNDEF);
 
-    public:
+        auto [begin, end] = lits(ca, tern, reason[id], other);
 
-        inline Decision(LID id, LST st, DStack& root) : deci(id, st), prop(), root(root) {
+        return std::all_of(begin, end, [this, id] (const L& l) -> bool {
 
-            root.check.push(id);
+            return l.getId() == id || seen[l.getId()] || levels[l.getId()] == 0;
+        });
+    }
 
-            root.ind[id] = &deci;
+public:
 
-            root.model[id] = st;
-        }
+    // polarity: of the first decision on every variable
+    explicit DStack(LID num, const Phases::Config& phaseConfig = Phases::Config(), LST polarity = TRUE)
+            : qhead(0), order(num), phases(num, polarity, phaseConfig), stamp(0), learntLbd(0) {
 
-        inline void registerProp(LID id, LST st, const std::vector<LID>& cause) {
+        trail.reserve(num);
 
-            root.check.push(id);
+        reason = std::vector<Reason>(num, Reason());
+        levels = std::vector<uint32_t>(num, 0);
+        model  = std::vector<LST>(num, UNDEF);
+        seen   = std::vector<char>(num, 0);
 
-            prop.emplace_back(id, st);
+        levelStamp = std::vector<uint64_t>((size_t)num + 1, 0);
+    }
 
-            root.depTree[id] = new DStack::DepNode(cause);
+    // As constructed, over the memory already allocated
+    void reset(LID num, const Phases::Config& phaseConfig = Phases::Config(), LST polarity = TRUE) {
 
-            root.ind[id] = &deci;
+        trail.clear();
+        trailLim.clear();
 
-            root.model[id] = st;
-        }
+        qhead     = 0;
+        stamp     = 0;
+        learntLbd = 0;
 
-        inline void registerProp(LID id, LST st) {
+        reason.assign(num, Reason());
+        levels.assign(num, 0);
+        model.assign(num, UNDEF);
+        seen.assign(num, 0);
 
-            root.check.push(id);
+        levelStamp.assign((size_t)num + 1, 0);
 
-            prop.emplace_back(id, st);
+        order.reset(num);
+        phases.reset(num, polarity, phaseConfig);
+    }
 
-            root.ind[id] = (new L(id, st)); //modif
+    // New unassigned variables up to num
+    void grow(LID num) {
 
-            root.model[id] = st;
-        }
+        if (num <= model.size())
+            return;
+
+        reason.resize(num, Reason());
+        levels.resize(num, 0);
+        model.resize(num, UNDEF);
+        seen.resize(num, 0);
+
+        levelStamp.resize((size_t)num + 1, 0);
 
-        inline ~Decision() {
+        order.grow(num);
+        phases.grow(num);
+    }
 
-            root.ind[deci.getId()] = nullptr;
+    // Number of distinct decision levels among the (assigned) literals
+    [[nodiscard]] uint32_t lbd(const L* begin, const L* end) {
 
-            root.model[deci.getId()] = UNDEF;
+        ++stamp;
 
-            for (const L& l: prop) {
+        uint32_t n = 0;
 
-                delete(root.depTree[l.getId()]);
-                root.depTree[l.getId()] = nullptr;
+        for (const L* l = begin; l != end; ++l) {
 
-                root.ind[l.getId()] = nullptr;
+            uint32_t lvl = levels[l->getId()];
 
-                root.model[l.getId()] = UNDEF;
+            if (levelStamp[lvl] != stamp) {
+                levelStamp[lvl] = stamp;
+                ++n;
             }
         }
 
-        [[nodiscard]] inline L getDeci() const {
+        return n;
+    }
 
-            return deci;
-        }
-    };
+    // First UIP analysis of a falsified clause. Undoes the trail down to the
+    // second highest level of the learned clause, which is returned with the
+    // asserting literal first and a literal of the backjump level second.
+    // A binary conflict also needs first, the literal its reason leaves out.
+    // onClause(cr) is called on every long clause resolved, before backjumping.
+    template <class F>
+    [[nodiscard]] std::vector<L> popConflict(const Arena& ca, const TernaryStore& tern,
+                                             Reason conflict, L first, F onClause) {
 
-    std::vector<DepNode*> depTree;
-    std::stack<Decision>  dStack;
-    std::vector<L*>       ind;
+        std::vector<L> learnt = std::vector<L>(1, L(0, UNDEF));
 
-    std::queue<LID>       check;
-    std::vector<LST>      model;
+        const uint32_t top = level();
 
-    void registerProp(LID id, LST st) {
+        int     pending = 0;
+        size_t  index   = trail.size();
+        LID     uip     = 0;
 
-        if (dStack.empty()) {
+        Reason cl        = conflict;
+        bool   atConflict = true;
 
-            check.push(id);
-            model[id] = st;
+        do {
 
-            ind[id] = (new L(id, st));
+            if (cl.kind() == LONG)
+                onClause(cl.cref());
 
-            //std::cout << "Empty stack" << std::endl;
+            // Room for a binary clause: the implied literal, then the other one
+            L pair[2] = {first, first};
 
-            return;
-        }
+            auto [begin, end] = lits(ca, tern, cl, pair[1]);
+
+            if (atConflict && cl.kind() == BINARY)
+                begin = pair;
+
+            for (const L* l = begin; l != end; ++l) {
+
+                LID id = l->getId();
+
+                if (seen[id] || (not atConflict && id == uip) || levels[id] == 0)
+                    continue;
+
+                seen[id] = 1;
+
+                order.bump(id);
+
+                if (levels[id] >= top)
+                    ++pending;
+                else
+                    learnt.emplace_back(id, (LST)-model[id]);
+            }
+
+            // Next literal of the current level to resolve on
+            while (not seen[trail[--index].getId()]);
+
+            uip = trail[index].getId();
+            cl  = reason[uip];
+
+            atConflict = false;
+            seen[uip]  = 0;
+            --pending;
+
+        } while (pending > 0);
+
+        learnt[0] = L(uip, (LST)-model[uip]);
+
+        // Drop literals implied by the rest of the clause
+        std::vector<L> kept = std::vector<L>(learnt.begin(), learnt.begin() + 1);
+
+        for (auto it = learnt.begin() + 1; it != learnt.end(); ++it)
+            if (not redundant(ca, tern, it->getId()))
+                kept.push_back(*it);
+
+        std::for_each(learnt.begin() + 1, learnt.end(), [this] (const L& l) { seen[l.getId()] = 0; });
+
+        learnt.swap(kept);
+
+        // Backjump level: highest level among the remaining literals
+        uint32_t back = 0;
+
+        for (size_t i = 1; i < learnt.size(); ++i)
+            if (levels[learnt[i].getId()] > back) {
+
+                back = levels[learnt[i].getId()];
+                std::swap(learnt[1], learnt[i]);
+            }
 
-        dStack.top().registerProp(id, st);
+        learntLbd = lbd(learnt.data(), learnt.data() + learnt.size());
+
+        order.decay();
+
+        backjump(back);
+
+        return learnt;
     }
 
-public:
+    // Why assumption p is false: p, and the decisions that imply its negation.
+    // Called while the decisions are the assumptions, they are then the
+    // assumptions to blame.
+    [[nodiscard]] std::vector<L> analyzeFinal(const Arena& ca, const TernaryStore& tern, L p) {
+
+        std::vector<L> out = std::vector<L>(1, p);
+
+        if (levels[p.getId()] == 0)
+            return out;
+
+        seen[p.getId()] = 1;
 
-    explicit DStack(LID num) {
+        for (size_t i = trail.size(); i > trailLim[0]; --i) {
+
+            LID id = trail[i - 1].getId();
+
+            if (not seen[id])
+                continue;
+
+            seen[id] = 0;
+
+            if (reason[id].none()) {
+
+                out.push_back(trail[i - 1]);
+                continue;
+            }
 
-        depTree = std::vector<DepNode*>(num, nullptr);
-        ind = std::vector<L*>(num, nullptr);
-        dStack = std::stack<Decision>();
-        check = std::queue<LID>();
-        model = std::vector<LST>(num, UNDEF);
+            L other = L(0, UNDEF);
+
+            auto [begin, end] = lits(ca, tern, reason[id], other);
+
+            for (const L* l = begin; l != end; ++l)
+                if (l->getId() != id && levels[l->getId()] > 0)
+                    seen[l->getId()] = 1;
+        }
+
+        return out;
     }
 
-    [[nodiscard]] std::vector<PL>* popConflict(const std::vector<LID>& conflict) {
+    // Undo every assignment above level lvl
+    void backjump(uint32_t lvl) {
 
-        std::set<L> acc = std::set<L>();
+        if (level() <= lvl)
+            return;
 
-        for (const LID& id: conflict)
-            DepNode::recGen(acc, *this, id);
+        for (size_t i = trail.size(); i > trailLim[lvl]; --i) {
 
-        //std::cout << std::endl;
+            LID id = trail[i - 1].getId();
 
-        check = std::queue<LID>();
+            phases.save(id, model[id]);
 
-        L d = dStack.top().getDeci();
+            model[id]  = UNDEF;
+            reason[id] = Reason();
 
-        dStack.pop();
+            order.insert(id);
+        }
 
-        d.reverse();
+        trail.erase(trail.begin() + (long)trailLim[lvl], trail.end());
+        trailLim.resize(lvl);
 
-        //std::cout << "<<" << d << std::endl;
+        qhead = trail.size();
+    }
 
-        std::vector<PL>& ret = *(new std::vector<PL>(acc.size()));
+    // Offer the current trail as target/best phases
+    inline void recordPhases() {
 
-        std::transform(acc.begin(), acc.end(), ret.begin(), [this] (const L& l) -> PL {
+        phases.record(trail.size(), [this] (auto visit) {
 
-            return {l.getId(), &model[l.getId()], (LST)-l.getSt()};
+            for (const L& l: trail)
+                visit(l.getId(), l.getSt());
         });
+    }
 
-        registerProp(d.getId(), d.getSt());
-/*
-        for (const PL& l: ret)
-            std::cout << L(l.getId(), l.getSt()) << " ";
-        std::cout << std::endl;*/
+    void registerProp(LID id, LST st, Reason cause) {
 
-        return &ret;
+        assign(id, st, cause);
     }
 
-    void registerProp(LID id, LST st, const std::vector<LID>& cause) {
+    void setDecision(LID id, LST st) {
 
-        if (dStack.empty()) {
+        trailLim.push_back(trail.size());
 
-            check.push(id);
-            model[id] = st;
+        assign(id, st, Reason());
+    }
 
-            ind[id] = (new L(id, st));
+    // A decision level without assignment, for an assumption already true
+    inline void newLevel() {
 
-            //std::cout << "Empty stack" << std::endl;
+        trailLim.push_back(trail.size());
+    }
 
-            return;
-        }
+    // Forget the values that are not on the trail, such as a model filled
+    // in from outside the search
+    void resetModel() {
 
-        if (cause.size() < 2) {
+        std::fill(model.begin(), model.end(), UNDEF);
 
-            check.push(id);
-            model[id] = st;
+        for (const L& l: trail)
+            model[l.getId()] = l.getSt();
+    }
 
-            ind[id] = (new L(id, st));
+    // A clause is locked while it is the reason of its first literal
+    [[nodiscard]] inline bool locked(const Arena& ca, CRef cr) const {
 
-            return;
+        L first = *ca.begin(cr);
+
+        return reason[first.getId()].isClause(cr) && model[first.getId()] == first.getSt();
+    }
+
+    // Garbage collection: move the long reasons of the trail into the new arena
+    void relocReasons(Arena& from, Arena& to) {
+
+        for (const L& l: trail) {
+
+            Reason& r = reason[l.getId()];
+
+            if (r.kind() != LONG)
+                continue;
+
+            // Level 0 reasons are never looked at again
+            if (from.deleted(r.cref()))
+                r = Reason();
+            else
+                r.setCRef(from.relocTo(to, r.cref()));
         }
+    }
+
+    [[nodiscard]] inline uint32_t lastLbd() const {
 
-        dStack.top().registerProp(id, st, cause);
+        return learntLbd;
     }
 
-    void setDecision(LID id, LST st) {
+    // Assignments so far, at all levels
+    [[nodiscard]] inline size_t assigned() const {
+
+        return trail.size();
+    }
+
+    [[nodiscard]] inline bool hasPending() const {
+
+        return qhead < trail.size();
+    }
+
+    [[nodiscard]] inline L nextPending() {
+
+        return trail[qhead++];
+    }
+
+    [[nodiscard]] inline uint32_t level() const {
+
+        return trailLim.size();
+    }
 
-        dStack.emplace(id, st, *this);
+    [[nodiscard]] inline VarHeap& getOrder() {
 
-        //std::cout << ">>" << L(id, st) << std::endl;
+        return order;
     }
 
-    [[nodiscard]] inline std::queue<LID>& getQueue() {
+    [[nodiscard]] inline Phases& getPhases() {
 
-        return check;
+        return phases;
     }
 
     [[nodiscard]] inline std::vector<LST>& getModel() {
@@ -223,7 +429,7 @@ public:
 
     [[nodiscard]] inline bool end() const {
 
-        return dStack.empty();
+        return trailLim.empty();
     }
 };
 
@@ -0,0 +1,205 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_FORMULA_H
+
+#include "satBasicDef.h"
+#include "ClauseKind.h"
+#include "../common/ClauseArena.h"
+#include "../common/Dimacs.h"
+#include "../common/Preprocess.h"
+#include <algorithm>
+#include <vector>
+
+// A formula read and preprocessed once, then shared read-only by every
+// Problem solving it: parallel workers only own their search state.
+//
+// The clauses as read stay for the final model check. The reduced formula
+// is in its own arena, its ternary clauses also in a TernaryStore so the
+// solvers propagate and analyse over the very same rows.
+class Formula {
+
+public:
+
+    typedef ClauseArena<L> Arena;
+
+private:
+
+    LID numVars;
+
+    // Clauses as read
+    Arena             input;
+    std::vector<CRef> original;
+
+    // Reduced formula, the clauses as read when no pass ran
+    Arena             reduced;
+    std::vector<CRef> clauses;
+
+    TernaryStore tern;
+
+    // Simplification before search, and model reconstruction after it
+    Preprocessor pre;
+
+    // An empty clause was read or derived by the preprocessor
+    bool unsat;
+
+    // Run the preprocessor on the clauses as read, the result goes to reduced
+    void preprocess(const Preprocessor::Passes& passes) {
+
+        pre = Preprocessor(numVars);
+
+        std::vector<int> c;
+
+        for (CRef cr: original) {
+
+            c.clear();
+
+            for (const L* l = input.begin(cr); l != input.end(cr); ++l)
+                c.push_back(l->getSt() == TRUE ? (int)l->getId() + 1 : -(int)l->getId() - 1);
+
+            pre.addClause(c);
+        }
+
+        if (not pre.run(passes)) {
+
+            unsat = true;
+            return;
+        }
+
+        std::vector<L> lits;
+
+        pre.forEachClause([this, &lits] (const std::vector<int>& rc) {
+
+            lits.clear();
+
+            for (int l: rc)
+                lits.push_back(l > 0 ? L(l - 1, TRUE) : L(-l - 1, FALSE));
+
+            clauses.push_back(reduced.alloc(lits.begin(), lits.end(), false));
+        });
+
+        pre.release();
+    }
+
+    // Whether lits has neither a repeated literal nor a literal and its
+    // negation. If not, sorted gets lits without repetitions, or nothing
+    // for a tautology.
+    static bool simple(const std::vector<L>& lits, std::vector<L>& sorted) {
+
+        sorted.assign(lits.begin(), lits.end());
+
+        std::sort(sorted.begin(), sorted.end(), [] (const L& a, const L& b) { return a.index() < b.index(); });
+
+        bool repeated = false;
+
+        for (size_t i = 1; i < sorted.size(); ++i) {
+
+            if (sorted[i].index() == sorted[i - 1].index())
+                repeated = true;
+            else if (sorted[i].getId() == sorted[i - 1].getId()) {
+
+                sorted.clear();
+                return false;
+            }
+        }
+
+        if (not repeated)
+            return true;
+
+        sorted.erase(std::unique(sorted.begin(), sorted.end(), [] (const L& a, const L& b) {
+
+            return a.index() == b.index();
+        }), sorted.end());
+
+        return false;
+    }
+
+public:
+
+    // path: DIMACS file, stdin if empty. Throws DimacsReader::Error on bad input
+    explicit Formula(const std::string& path, const Preprocessor::Passes& passes = Preprocessor::Passes())
+            : numVars(), unsat(false) {
+
+        DimacsReader reader = DimacsReader(path);
+
+        std::vector<L> sorted;
+
+        DimacsReader::Result res = reader.read<L>(
+                [] (int lit) { return lit > 0 ? L(lit - 1, TRUE) : L(-lit - 1, FALSE); },
+                [this, &passes, &sorted] (const std::vector<L>& lits) {
+
+                    // The preprocessor cleans clauses up itself, the watches need it otherwise
+                    if (passes.any() || simple(lits, sorted))
+                        original.push_back(input.alloc(lits.begin(), lits.end(), false));
+                    else if (not sorted.empty())
+                        original.push_back(input.alloc(sorted.begin(), sorted.end(), false));
+                });
+
+        numVars = res.vars();
+
+        if (passes.any())
+            preprocess(passes);
+
+        for (CRef cr: getClauses()) {
+
+            const L* c = arena().begin(cr);
+
+            if (arena().size(cr) == 0)
+                unsat = true;
+            else if (arena().size(cr) == 3)
+                tern.add(c[0], c[1], c[2]);
+        }
+    }
+
+    // No clauses and no variables, for a Problem that gets its clauses one by one
+    Formula() : numVars(0), unsat(false) {}
+
+    Formula(const Formula&) = delete;
+    Formula& operator = (const Formula&) = delete;
+
+    // Arena of the reduced formula
+    [[nodiscard]] inline const Arena& arena() const {
+
+        return pre.hasRun() ? reduced : input;
+    }
+
+    // Clauses of the reduced formula, in arena()
+    [[nodiscard]] inline const std::vector<CRef>& getClauses() const {
+
+        return pre.hasRun() ? clauses : original;
+    }
+
+    // Ternary clauses of the reduced formula, in the order of getClauses()
+    [[nodiscard]] inline const TernaryStore& ternaries() const {
+
+        return tern;
+    }
+
+    // Calls f(begin, end) on every clause as read
+    template <class F>
+    void forEachInput(F f) const {
+
+        for (CRef cr: original)
+            f(input.begin(cr), input.end(cr));
+    }
+
+    [[nodiscard]] inline const Preprocessor& preprocessor() const {
+
+        return pre;
+    }
+
+    [[nodiscard]] inline LID vars() const {
+
+        return numVars;
+    }
+
+    [[nodiscard]] inline bool isUnsat() const {
+
+        return unsat;
+    }
+};
+
+#define LI_SAT_SOLVER_FORMULA_H
+
+#endif //LI_SAT_SOLVER_FORMULA_H
@@ -0,0 +1,318 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_LEARNTDB_H
+
+#include "satBasicDef.h"
+#include "../common/ClauseArena.h"
+#include <algorithm>
+#include <vector>
+
+// Learned clauses by tier of their LBD (number of decision levels they span):
+//
+//   CORE  (LBD <= 2) kept forever
+//   TIER2 (LBD <= 6) kept while used between two reductions, demoted otherwise
+//   LOCAL            the least active half is dropped at every reduction
+//
+// Tier and usage live in the spare header bits of the arena.
+class LearntDB {
+
+public:
+
+    typedef ClauseArena<L> Arena;
+
+    enum Tier : uint32_t {
+        CORE  = 0,
+        TIER2 = 1,
+        LOCAL = 2
+    };
+
+private:
+
+    static constexpr uint32_t TIER_MASK = 3;
+    static constexpr uint32_t USED      = 4;
+
+    std::vector<CRef> clauses;
+
+    float inc;
+    float decayF;
+
+    // Conflicts of the next reduction, the gap grows after each one
+    uint64_t nextReduce;
+    uint64_t interval;
+
+    // The schedule as constructed, for clear()
+    uint64_t firstReduce;
+    uint64_t firstInterval;
+
+public:
+
+    explicit LearntDB(float decay = 0.999f, uint64_t first = 2000, uint64_t interval = 300)
+            : inc(1), decayF(decay), nextReduce(first), interval(interval), firstReduce(first),
+              firstInterval(interval) {}
+
+    // No clauses and the reduction schedule from the start, the list keeps its capacity
+    void clear() {
+
+        clauses.clear();
+
+        inc        = 1;
+        nextReduce = firstReduce;
+        interval   = firstInterval;
+    }
+
+    [[nodiscard]] static inline Tier tierOf(uint32_t lbd) {
+
+        return lbd <= 2 ? CORE : lbd <= 6 ? TIER2 : LOCAL;
+    }
+
+    [[nodiscard]] static inline Tier tier(const Arena& ca, CRef cr) {
+
+        return (Tier)(ca.extra(cr) & TIER_MASK);
+    }
+
+    void add(Arena& ca, CRef cr, uint32_t lbd) {
+
+        ca.setLbd(cr, lbd);
+        ca.setExtra(cr, tierOf(lbd));
+        ca.activity(cr) = inc;
+
+        clauses.push_back(cr);
+    }
+
+    // The clause took part in a conflict: bump it, and promote it if its LBD improved
+    void bump(Arena& ca, CRef cr, uint32_t lbd) {
+
+        if ((ca.activity(cr) += inc) > 1e20f) {
+
+            for (CRef c: clauses)
+                ca.activity(c) *= 1e-20f;
+
+            inc *= 1e-20f;
+        }
+
+        Tier t = tier(ca, cr);
+
+        if (lbd < ca.lbd(cr)) {
+
+            ca.setLbd(cr, lbd);
+            t = std::min(t, tierOf(lbd));
+        }
+
+        ca.setExtra(cr, t | USED);
+    }
+
+    inline void decay() {
+
+        inc /= decayF;
+    }
+
+    [[nodiscard]] inline bool due(uint64_t conflicts) const {
+
+        return conflicts >= nextReduce;
+    }
+
+    // Free the worst half of the local tier, except clauses that are reasons
+    // on the trail. Watches of freed clauses are left to the caller.
+    template <class Locked>
+    void reduce(Arena& ca, Locked locked) {
+
+        interval += 300;
+        nextReduce += interval;
+
+        std::vector<CRef> local;
+
+        for (CRef cr: clauses) {
+
+            uint32_t e = ca.extra(cr);
+
+            switch (e & TIER_MASK) {
+
+                case TIER2:
+
+                    // Unused since the last reduction: demote
+                    ca.setExtra(cr, e & USED ? TIER2 : LOCAL);
+                    break;
+                case LOCAL:
+
+                    ca.setExtra(cr, LOCAL);
+
+                    if (not locked(cr))
+                        local.push_back(cr);
+                    break;
+                default:
+                    ca.setExtra(cr, e & TIER_MASK);
+            }
+        }
+
+        std::sort(local.begin(), local.end(), [&ca] (CRef a, CRef b) {
+
+            if (ca.activity(a) != ca.activity(b))
+                return ca.activity(a) < ca.activity(b);
+
+            return ca.lbd(a) > ca.lbd(b);
+        });
+
+        for (size_t i = 0; i < local.size() / 2; ++i)
+            ca.free(local[i]);
+
+        removeFreed(ca);
+    }
+
+    // Subsumption among the learned clauses, shortest first. A subsumed clause
+    // is freed and its subsumer inherits the better tier. A clause that only
+    // loses one literal (self-subsuming resolution) is freed as well, and
+    // strengthen(lits) gets the shorter literals and returns the new clause,
+    // or CRef_Undef if it did not allocate one. Locked clauses are skipped.
+    template <class Locked, class Strengthen>
+    void subsume(Arena& ca, size_t numVars, Locked locked, Strengthen strengthen) {
+
+        std::vector<CRef> cands;
+
+        for (CRef cr: clauses)
+            if (not ca.deleted(cr) && not locked(cr))
+                cands.push_back(cr);
+
+        std::stable_sort(cands.begin(), cands.end(), [&ca] (CRef a, CRef b) { return ca.size(a) < ca.size(b); });
+
+        // One bit per variable modulo 64, a clause can only contain clauses whose signature it covers
+        std::vector<uint64_t> sigs = std::vector<uint64_t>(cands.size(), 0);
+
+        std::vector<std::vector<uint32_t>> occurs = std::vector<std::vector<uint32_t>>(2 * numVars);
+
+        for (uint32_t i = 0; i < cands.size(); ++i)
+            for (const L* l = ca.begin(cands[i]); l != ca.end(cands[i]); ++l) {
+
+                sigs[i] |= (uint64_t)1 << (l->getId() & 63);
+                occurs[l->index()].push_back(i);
+            }
+
+        std::vector<int8_t> mark = std::vector<int8_t>(numVars, 0);
+
+        std::vector<L> lits;
+
+        for (uint32_t i = 0; i < cands.size(); ++i) {
+
+            CRef c = cands[i];
+
+            if (ca.deleted(c))
+                continue;
+
+            // Every candidate contains the variable of c with the fewest occurrences
+            L best = *ca.begin(c);
+
+            for (const L* l = ca.begin(c); l != ca.end(c); ++l) {
+
+                mark[l->getId()] = l->getSt();
+
+                L nl = *l;
+                nl.reverse();
+
+                L nb = best;
+                nb.reverse();
+
+                if (occurs[l->index()].size() + occurs[nl.index()].size() <
+                    occurs[best.index()].size() + occurs[nb.index()].size())
+                    best = *l;
+            }
+
+            L other = best;
+            other.reverse();
+
+            for (L pivot: {best, other})
+                for (uint32_t j: occurs[pivot.index()]) {
+
+                    CRef d = cands[j];
+
+                    if (j == i || ca.deleted(d) || ca.size(d) < ca.size(c) || (sigs[i] & ~sigs[j]) != 0)
+                        continue;
+
+                    uint32_t found   = 0;
+                    const L* flipped = nullptr;
+
+                    for (const L* l = ca.begin(d); l != ca.end(d); ++l) {
+
+                        int8_t m = mark[l->getId()];
+
+                        if (m == 0)
+                            continue;
+
+                        if (m != l->getSt()) {
+
+                            if (flipped != nullptr)
+                                break;
+
+                            flipped = l;
+                        }
+
+                        ++found;
+                    }
+
+                    if (found < ca.size(c))
+                        continue;
+
+                    uint32_t lbd = ca.lbd(d);
+                    Tier     t   = tier(ca, d);
+
+                    if (flipped == nullptr) {
+
+                        if (t < tier(ca, c))
+                            ca.setExtra(c, t | (ca.extra(c) & USED));
+
+                        ca.setLbd(c, std::min(lbd, ca.lbd(c)));
+                        ca.free(d);
+                        continue;
+                    }
+
+                    lits.clear();
+
+                    for (const L* l = ca.begin(d); l != ca.end(d); ++l)
+                        if (l != flipped)
+                            lits.push_back(*l);
+
+                    float act = ca.activity(d);
+
+                    ca.free(d);
+
+                    // May move the arena, no pointers into it are kept
+                    CRef n = strengthen(lits);
+
+                    if (n == CRef_Undef)
+                        continue;
+
+                    add(ca, n, std::min(lbd, ca.size(n)));
+                    ca.activity(n) = act;
+                }
+
+            for (const L* l = ca.begin(c); l != ca.end(c); ++l)
+                mark[l->getId()] = 0;
+        }
+
+        removeFreed(ca);
+    }
+
+    inline void removeFreed(const Arena& ca) {
+
+        auto kept = std::remove_if(clauses.begin(), clauses.end(), [&ca] (CRef cr) {
+
+            return ca.deleted(cr);
+        });
+
+        clauses.erase(kept, clauses.end());
+    }
+
+    [[nodiscard]] inline std::vector<CRef>& getClauses() {
+
+        return clauses;
+    }
+
+    [[nodiscard]] inline const std::vector<CRef>& getClauses() const {
+
+        return clauses;
+    }
+};
+
+#define LI_SAT_SOLVER_LEARNTDB_H
+
+#endif //LI_SAT_SOLVER_LEARNTDB_H
@@ -0,0 +1,111 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_PORTFOLIO_H
+
+#include "Problem.h"
+#include "ClauseExchange.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// N diversified Problems racing on one shared Formula, each in its own
+// thread. They exchange their short learned clauses, and the first answer
+// stops the others.
+//
+// Worker 0 runs the configuration as given. The others differ in seed,
+// first polarity, restart policy, target phases and where their rephase
+// schedule starts, so that no two of them search alike.
+class Portfolio {
+
+private:
+
+    const Formula& formula;
+
+    std::vector<ProblemConfig> configs;
+
+    ClauseExchange exchange;
+
+    std::atomic<bool> stop;
+
+    std::atomic<int> answer;
+    size_t           winner;
+
+public:
+
+    [[nodiscard]] static ProblemConfig diversify(const ProblemConfig& base, size_t i) {
+
+        ProblemConfig config = base;
+
+        if (i == 0)
+            return config;
+
+        config.phases.seed += (uint32_t)i;
+
+        if (i % 2 == 1)
+            config.polarity = (LST)-base.polarity;
+
+        if (i % 4 >= 2)
+            config.restart = base.restart == Restart::LUBY ? Restart::GLUCOSE : Restart::LUBY;
+
+        if (i % 8 >= 4)
+            config.phases.target = not base.phases.target;
+
+        std::vector<Phases::Kind>& schedule = config.phases.schedule;
+
+        if (not schedule.empty())
+            std::rotate(schedule.begin(), schedule.begin() + (long)(i % schedule.size()), schedule.end());
+
+        return config;
+    }
+
+    Portfolio(const Formula& formula, const ProblemConfig& base, size_t workers)
+            : formula(formula), exchange(workers), stop(false), answer(UNKNOWN), winner(0) {
+
+        for (size_t i = 0; i < workers; ++i)
+            configs.push_back(diversify(base, i));
+    }
+
+    Result solve() {
+
+        std::vector<std::thread> threads;
+
+        for (size_t i = 0; i < configs.size(); ++i)
+            threads.emplace_back([this, i] () {
+
+                Problem problem = Problem(formula, configs[i]);
+
+                problem.interruptOn(stop);
+
+                if (configs.size() > 1)
+                    problem.share(exchange, i);
+
+                Result res = problem.solve();
+
+                int none = UNKNOWN;
+
+                if (res != UNKNOWN && answer.compare_exchange_strong(none, res)) {
+
+                    winner = i;
+                    stop.store(true);
+                }
+            });
+
+        for (std::thread& t: threads)
+            t.join();
+
+        return (Result)answer.load();
+    }
+
+    // Worker that found the answer
+    [[nodiscard]] inline size_t getWinner() const {
+
+        return winner;
+    }
+};
+
+#define LI_SAT_SOLVER_PORTFOLIO_H
+
+#endif //LI_SAT_SOLVER_PORTFOLIO_H
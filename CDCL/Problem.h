@@ -5,297 +5,1205 @@
 #ifndef LI_SAT_SOLVER_PROBLEM_H
 
 #include "DStack.h"
+#include "ClauseExchange.h"
+#include "Formula.h"
+#include "LearntDB.h"
+#include "Restart.h"
+#include "../common/LocalSearch.h"
+#include "../common/Preprocess.h"
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <algorithm>
-#include <list>
-#include <cmath>
+
+// Runtime settings of the engine, filled from the command line by satRun.cpp
+struct ProblemConfig {
+
+    // CDCL search, or local search only (incomplete: it never proves unsatisfiability)
+    enum Mode {
+        CDCL,
+        SLS
+    };
+
+    Mode mode = CDCL;
+
+    // Flip limit of the local search mode, 0 for none
+    uint64_t slsFlips = 0;
+
+    Restart::Policy restart = Restart::GLUCOSE;
+    Phases::Config  phases;
+
+    // Value of the first decision on every variable
+    LST polarity = TRUE;
+
+    // Flips of the first walk rephase per clause, each walk gets half more than the last
+    uint64_t walkEffort = 100;
+
+    Preprocessor::Passes preprocess;
+
+    // Conflicts between two subsumption rounds over the learned clauses, 0 for none
+    uint64_t subsumeInterval = 5000;
+
+    // Learned clauses offered to the other workers of a portfolio: units,
+    // binaries, and the clauses up to this LBD
+    uint32_t exportLbd = 2;
+};
+
+// One CDCL search over a shared Formula, which it never modifies: several
+// Problems on the same Formula can run in parallel threads. solve() returns
+// the answer, or UNKNOWN when interrupted or out of local search flips.
 
 class Problem {
 
 private:
 
-    typedef std::vector<PL> Clause;
+    // Component microbenchmarks, bench/MicroCdcl.cpp
+    friend struct ProblemMicro;
+
+    typedef DStack::Arena Arena;
 
-    std::vector<Clause> root;
+    // Watch list entry: the blocker is some other literal of the clause,
+    // if it is true the clause is satisfied and needs not be visited
+    struct Watch {
 
-    std::vector<std::list<Clause*>> cLitTrue;
-    std::vector<std::list<Clause*>> cLitFalse;
+        CRef cr;
+        L    blocker;
+
+        inline Watch(CRef cr, L blocker) : cr(cr), blocker(blocker) {}
+    };
+
+    // Watch list entry of a ternary clause: its two other literals, and its
+    // row in the store for conflict analysis
+    struct TernaryWatch {
+
+        L    a;
+        L    b;
+        TRef t;
+
+        inline TernaryWatch(L a, L b, TRef t) : a(a), b(b), t(t) {}
+    };
+
+    // Clauses as read, reduced formula and model reconstruction
+    const Formula* formula;
+
+    // Long clauses, original and learned, live in the arena. The original
+    // ones are copied from the formula: watching reorders their literals.
+    Arena ca;
+
+    // Original long clauses
+    std::vector<CRef> root;
+
+    // Original ternary clauses, those of the formula
+    const TernaryStore* tern;
+
+    // Per literal l, visited when l becomes false:
+    //   binWatches[l.index()]:  other literal of every binary clause of l
+    //   ternWatches[l.index()]: every ternary clause of l
+    //   watches[l.index()]:     long clauses watching l
+    std::vector<std::vector<L>>            binWatches;
+    std::vector<std::vector<TernaryWatch>> ternWatches;
+    std::vector<std::vector<Watch>>        watches;
 
     DStack stack;
 
-    std::queue<LID>*  check;
     std::vector<LST>* model;
 
-    std::vector<Clause> conClauses;
+    LearntDB conClauses;
+
+    // Level 0 assignments when learned clauses were last simplified
+    size_t simplified;
+
+    uint64_t conflicts;
+    uint64_t decisions;
+
+    // Literals whose watches were visited
+    uint64_t propagations;
+
+    Restart restart;
 
     LID      numVars;
     uint64_t numClauses;
 
-    [[nodiscard]] int printSat() const {
+    ProblemConfig config;
 
-        for (const Clause& cl: conClauses)
-            if (std::all_of(cl.begin(), cl.end(), PL::isFalseS)) {
+    // Conflicts of the next subsumption round over the learned clauses
+    uint64_t nextSubsume;
 
-                for (const PL& pl: cl)
-                    std::cout << L(pl.getId(), pl.getSt());
+    // Local search over the clauses after preprocessing, for walk rephases
+    // and the local search mode
+    LocalSearch walker;
+    uint64_t    walkFlips;
 
-                std::cout << std::endl;
+    // Answer so far, UNKNOWN while searching
+    Result status;
 
-                std::cout << "CONTRADICTION" << std::endl;
-                break;
-            }
+    // Falsified clause found by findConflict(), and for a binary one the
+    // literal that just became false
+    Reason conflict;
+    L      conflictLit = L(0, UNDEF);
+
+    // Set by another thread to stop the search, if any
+    const std::atomic<bool>* stop;
+
+    // Decisions made first by solve(), refuting them ends the call
+    std::vector<L> assumptions;
 
+    // Learned clauses shared with the other workers of a portfolio, if any
+    ClauseExchange* exchange;
+    size_t          worker;
 
-        std::cout << "SATISFIABLE" << ' ' << std::endl;
+    // Incremental use: asked between decisions whether to give up
+    std::function<bool()> terminate;
 
-        return 20;
+    // Incremental use: sees the learned clauses up to learnLength literals
+    std::function<void(const std::vector<L>&)> learnHook;
+    size_t                                     learnLength;
+
+    // Assumptions to blame when the last solve() refuted them
+    std::vector<L> failed;
+
+    [[nodiscard]] inline bool interrupted() const {
+
+        return (stop != nullptr && stop->load(std::memory_order_relaxed)) || (terminate && terminate());
     }
 
-    static int printNotSat() {
+    [[nodiscard]] inline bool isTrue(const L& l) const {
 
-        std::cout << "UNSATISFIABLE" << ' ' << std::endl;
-        return 10;
+        return (*model)[l.getId()] == l.getSt();
     }
 
-    bool clauseConflict(const Clause& c) {
+    [[nodiscard]] inline bool isFalse(const L& l) const {
 
-        bool one = false;
+        return (*model)[l.getId()] == -l.getSt();
+    }
 
-        LID id;
-        LST st;
+    // 1 true, 0 unassigned, -1 false
+    [[nodiscard]] inline int value(const L& l) const {
 
-        std::vector<LID> cause = std::vector<LID>();
+        return (*model)[l.getId()] * l.getSt();
+    }
 
-        for (PL l: c)
-            if (l.isTrue())
-                return false;
-            else if (l.isUndef()) {
+    // One empty list per literal, those already allocated keep their capacity
+    template <class T>
+    void recycle(std::vector<std::vector<T>>& lists) {
 
-                if (one) return false;
+        for (std::vector<T>& list: lists)
+            list.clear();
 
-                id = l.getId();
-                st = l.getSt();
+        lists.resize(2 * (size_t)numVars);
+    }
 
-                one = true;
+    void addBinary(L a, L b) {
 
-            } else cause.push_back(l.getId());
+        binWatches[a.index()].push_back(b);
+        binWatches[b.index()].push_back(a);
+    }
 
-        if (not one) return true;
+    // Every literal of a ternary clause watches it
+    void watchTernary(TRef t) {
 
-        stack.registerProp(id, st, cause);
-        return false;
+        const L* c = tern->begin(t);
+
+        ternWatches[c[0].index()].emplace_back(c[1], c[2], t);
+        ternWatches[c[1].index()].emplace_back(c[0], c[2], t);
+        ternWatches[c[2].index()].emplace_back(c[0], c[1], t);
     }
 
-    void tryBacktrack(Clause* cl) {
+    // Watch the first two literals of cr, each one blocked by the other
+    void attach(CRef cr) {
 
-        if (stack.end())
-            exit(printNotSat());
+        L* c = ca.begin(cr);
 
-        std::vector<LID> conflict = std::vector<LID>(cl->size());
+        watches[c[0].index()].emplace_back(cr, c[1]);
+        watches[c[1].index()].emplace_back(cr, c[0]);
+    }
 
-        std::transform(cl->begin(), cl->end(), conflict.begin(),
-                       [] (const PL &lit) -> LID {
+    // first: for a binary conflict, the literal that just became false
+    void tryBacktrack(Reason confl, L first) {
 
-                           return lit.getId();
-                       });
+        if (stack.end()) {
 
-        Clause* stop = stack.popConflict(conflict);
+            status = UNSATISFIABLE;
+            return;
+        }
 
-        conClauses.push_back(*stop);
+        ++conflicts;
 
-        for (const PL& l: *stop)
-            if (l.getSt() == TRUE)
-                cLitTrue[l.getId()].push_front(stop);
-            else
-                cLitFalse[l.getId()].push_front(stop);
-    }
+        size_t trail = stack.assigned();
 
-    bool propagate() {
+        stack.recordPhases();
 
-        while (not check->empty()) {
+        std::vector<L> learnt = stack.popConflict(ca, *tern, confl, first, [this] (CRef cr) {
 
-            LID id = check->front();
-            check->pop();
+            if (ca.learnt(cr))
+                conClauses.bump(ca, cr, stack.lbd(ca.begin(cr), ca.end(cr)));
+        });
 
-            if ((*model)[id] == TRUE) {
+        conClauses.decay();
 
-                for (Clause* cl: cLitFalse[id])
-                    if (clauseConflict(*cl)) {
+        restart.onConflict(stack.lastLbd(), trail);
 
-                        tryBacktrack(cl);
-                        return true;
-                    }
+        if (exchange != nullptr && (learnt.size() <= 2 || stack.lastLbd() <= config.exportLbd))
+            exchange->publish(worker, learnt.data(), learnt.data() + learnt.size(), stack.lastLbd());
 
-            } else {
+        if (learnHook && learnt.size() <= learnLength)
+            learnHook(learnt);
 
-                for (Clause* cl: cLitTrue[id])
-                    if (clauseConflict(*cl)) {
+        // Asserting literal: implied by the learned clause at the backjump level
+        if (learnt.size() == 1) {
 
-                        tryBacktrack(cl);
-                        return true;
-                    }
+            stack.registerProp(learnt[0].getId(), learnt[0].getSt(), Reason());
+            return;
+        }
+
+        // Learned binary clauses are kept forever
+        if (learnt.size() == 2) {
+
+            addBinary(learnt[0], learnt[1]);
+
+            stack.registerProp(learnt[0].getId(), learnt[0].getSt(), Reason::binary(learnt[1]));
+            return;
+        }
+
+        CRef cr = ca.alloc(learnt.begin(), learnt.end(), true);
+
+        conClauses.add(ca, cr, stack.lastLbd());
+
+        attach(cr);
+
+        stack.registerProp(learnt[0].getId(), learnt[0].getSt(), Reason::clause(cr));
+    }
+
+    // Visit the clauses of kind K of falseLit, which has just become false.
+    // On a conflict, keeps it in conflict and returns true.
+    template <ClauseKind K>
+    bool propagateKind(const L& falseLit) {
+
+        if constexpr (K == BINARY) {
+
+            for (const L& other: binWatches[falseLit.index()]) {
+
+                int v = value(other);
+
+                if (v == 1)
+                    continue;
+
+                if (v == 0) {
+
+                    stack.registerProp(other.getId(), other.getSt(), Reason::binary(falseLit));
+                    continue;
+                }
+
+                conflict    = Reason::binary(other);
+                conflictLit = falseLit;
+                return true;
             }
 
+            return false;
+        }
+
+        if constexpr (K == TERNARY) {
+
+            for (const TernaryWatch& w: ternWatches[falseLit.index()]) {
+
+                int va = value(w.a);
+                int vb = value(w.b);
+
+                // 0: satisfied or two unassigned literals, 1: unit, 2: falsified
+                int status = ((va != 1) & (vb != 1)) * (2 - (va == 0) - (vb == 0));
+
+                if (status == 0)
+                    continue;
+
+                if (status == 1) {
+
+                    L unit = va == 0 ? w.a : w.b;
+
+                    stack.registerProp(unit.getId(), unit.getSt(), Reason::ternary(w.t));
+                    continue;
+                }
+
+                conflict    = Reason::ternary(w.t);
+                conflictLit = falseLit;
+                return true;
+            }
 
+            return false;
         }
 
-        return false;
+        if constexpr (K == LONG)
+            return propagateLong(falseLit);
     }
 
-    void compPriority() {
+    // Visit the clauses watching falseLit, which has just become false
+    bool propagateWatches(const L& falseLit) {
 
-        std::vector<float> value = std::vector<float>(numVars, 1);
+        return propagateKind<BINARY>(falseLit) || propagateKind<TERNARY>(falseLit) ||
+               propagateKind<LONG>(falseLit);
+    }
 
-        auto i = 1;
+    // Two watched literals with blockers
+    bool propagateLong(const L& falseLit) {
 
-        for (auto it = root.rbegin(); it != root.rend(); ++it) {
+        std::vector<Watch>& ws = watches[falseLit.index()];
 
-            for (PL& pl: *it) {
+        auto i = ws.begin();
+        auto j = ws.begin();
 
-                float &f = value[pl.getId()];
+        while (i != ws.end()) {
 
-                f += static_cast<float>(log2(i));
+            // Satisfied through the blocker, the clause is not touched
+            if (isTrue(i->blocker)) {
+                *j++ = *i++;
+                continue;
+            }
 
-                pl.setValue(f);
+            CRef cr = i->cr;
+
+            // Removed clauses leave the watches lazily
+            if (ca.deleted(cr)) {
+                ++i;
+                continue;
+            }
+
+            L* c = ca.begin(cr);
+
+            // Keep the falsified watch in c[1]
+            if (c[0].index() == falseLit.index())
+                std::swap(c[0], c[1]);
+
+            L first = c[0];
+
+            if (first.index() != i->blocker.index() && isTrue(first)) {
+                *j++ = Watch(cr, first);
+                ++i;
+                continue;
             }
 
             ++i;
+
+            // Look for a new literal to watch
+            bool moved = false;
+
+            for (uint32_t k = 2, n = ca.size(cr); k < n; ++k)
+                if (not isFalse(c[k])) {
+
+                    std::swap(c[1], c[k]);
+                    watches[c[1].index()].emplace_back(cr, first);
+
+                    moved = true;
+                    break;
+                }
+
+            if (moved)
+                continue;
+
+            *j++ = Watch(cr, first);
+
+            if ((*model)[first.getId()] == UNDEF) {
+
+                stack.registerProp(first.getId(), first.getSt(), Reason::clause(cr));
+                continue;
+            }
+
+            // Conflict: keep the remaining watches untouched
+            while (i != ws.end())
+                *j++ = *i++;
+
+            ws.erase(j, ws.end());
+
+            conflict    = Reason::clause(cr);
+            conflictLit = falseLit;
+            return true;
+        }
+
+        ws.erase(j, ws.end());
+        return false;
+    }
+
+    // At level 0: drop the learned clauses satisfied by the permanent assignments
+    void simplify() {
+
+        if (stack.assigned() == simplified)
+            return;
+
+        simplified = stack.assigned();
+
+        for (CRef cr: conClauses.getClauses())
+            if (std::any_of(ca.begin(cr), ca.end(cr), [this] (const L& l) { return isTrue(l); }))
+                ca.free(cr);
+
+        conClauses.removeFreed(ca);
+
+        if (ca.wasted() > ca.words() / 5)
+            collectGarbage();
+    }
+
+    void reduceDB() {
+
+        conClauses.reduce(ca, [this] (CRef cr) { return stack.locked(ca, cr); });
+
+        if (ca.wasted() > ca.words() / 5)
+            collectGarbage();
+        else
+            purgeWatches();
+    }
+
+    // At level 0: subsumption and strengthening among the learned clauses
+    void subsumeLearnts() {
+
+        nextSubsume = conflicts + config.subsumeInterval;
+
+        conClauses.subsume(ca, numVars, [this] (CRef cr) { return stack.locked(ca, cr); },
+                           [this] (std::vector<L>& lits) { return addRootClause(lits, true); });
+
+        if (ca.wasted() > ca.words() / 5)
+            collectGarbage();
+        else
+            purgeWatches();
+    }
+
+    // At level 0: add a clause, learned or original. Literals fixed at
+    // level 0 are dropped, or the clause if one is true. Units are assigned,
+    // binaries watched, and the attached long clause returned for the
+    // caller to keep, CRef_Undef otherwise.
+    CRef addRootClause(std::vector<L>& lits, bool learnt) {
+
+        if (std::any_of(lits.begin(), lits.end(), [this] (const L& l) { return isTrue(l); }))
+            return CRef_Undef;
+
+        lits.erase(std::remove_if(lits.begin(), lits.end(), [this] (const L& l) { return isFalse(l); }),
+                   lits.end());
+
+        if (lits.empty()) {
+
+            status = UNSATISFIABLE;
+            return CRef_Undef;
         }
 
+        if (lits.size() == 1) {
+
+            stack.registerProp(lits[0].getId(), lits[0].getSt(), Reason());
+            return CRef_Undef;
+        }
+
+        if (lits.size() == 2) {
+
+            addBinary(lits[0], lits[1]);
+            return CRef_Undef;
+        }
+
+        CRef cr = ca.alloc(lits.begin(), lits.end(), learnt);
+
+        attach(cr);
+
+        return cr;
     }
 
-    static void printErrorTerm(const Clause& c) {
+    // At level 0: take the clauses the other workers learned since last time
+    void importClauses() {
+
+        std::vector<L> lits;
+
+        exchange->collect(worker, [this, &lits] (const L* begin, const L* end, uint32_t lbd) {
+
+            if (status != UNKNOWN)
+                return;
+
+            lits.assign(begin, end);
+
+            CRef cr = addRootClause(lits, true);
+
+            if (cr != CRef_Undef)
+                conClauses.add(ca, cr, std::min(lbd, ca.size(cr)));
+        });
+    }
+
+    // Detach freed clauses from every watch list
+    void purgeWatches() {
+
+        for (std::vector<Watch>& ws: watches) {
+
+            auto kept = std::remove_if(ws.begin(), ws.end(), [this] (const Watch& w) {
+
+                return ca.deleted(w.cr);
+            });
+
+            ws.erase(kept, ws.end());
+        }
+    }
+
+    // Compact the arena: live clauses move to a fresh one, every reference follows
+    void collectGarbage() {
+
+        Arena to;
+
+        to.reserve(ca.words() - ca.wasted());
+
+        stack.relocReasons(ca, to);
+
+        purgeWatches();
+
+        for (std::vector<Watch>& ws: watches)
+            for (Watch& w: ws)
+                w.cr = ca.relocTo(to, w.cr);
+
+        for (CRef& cr: root)
+            cr = ca.relocTo(to, cr);
+
+        for (CRef& cr: conClauses.getClauses())
+            cr = ca.relocTo(to, cr);
+
+        to.moveTo(ca);
+    }
+
+    // Propagate the pending literals up to the first falsified clause, left
+    // in conflict without analysing it
+    bool findConflict() {
+
+        while (stack.hasPending()) {
+
+            L l = stack.nextPending();
+
+            ++propagations;
+
+            l.reverse();
+
+            if (propagateWatches(l))
+                return true;
+        }
+
+        return false;
+    }
+
+    // On a conflict, learn from it, backjump and return true
+    bool propagate() {
+
+        if (not findConflict())
+            return false;
+
+        tryBacktrack(conflict, conflictLit);
+        return true;
+    }
+
+    // A wrong model is a bug of the solver, not an answer
+    static void printErrorTerm(const L* begin, const L* end) {
 
         std::cout << "Error in model, clause is not satisfied:";
 
-        for (const PL& l: c)
-            std::cout << stateToSymbol(l.getSt()) << l.getId() + 1 << " ";
+        for (const L* l = begin; l != end; ++l)
+            std::cout << stateToSymbol(l->getSt()) << l->getId() + 1 << " ";
 
         std::cout << std::endl;
         exit(1);
     }
 
-    static bool someLitTrue(const Clause& c) {
+    void checkClause(const L* begin, const L* end) const {
+
+        if (std::none_of(begin, end, [this] (const L& l) { return isTrue(l); }))
+            printErrorTerm(begin, end);
+    }
+
+    // Against the clauses as read, the preprocessor may have replaced some of them
+    void checkModel() const {
+
+        formula->forEachInput([this] (const L* begin, const L* end) { checkClause(begin, end); });
+
+        // Those of the reduced formula, and the ones added since
+        for (CRef cr: root)
+            checkClause(ca.begin(cr), ca.end(cr));
+
+        for (CRef cr: conClauses.getClauses())
+            if (std::all_of(ca.begin(cr), ca.end(cr), [this] (const L& l) { return isFalse(l); })) {
+
+                for (const L* l = ca.begin(cr); l != ca.end(cr); ++l)
+                    std::cout << *l;
+
+                std::cout << std::endl;
 
-        return any_of(c.begin(), c.end(), PL::isTrueS);
+                std::cout << "CONTRADICTION" << std::endl;
+                break;
+            }
     }
 
-    void checkModel() {
+    // Every variable has a value: extend the model to the original formula and check it
+    void finish() {
+
+        formula->preprocessor().extend([this] (int var) { return (int8_t)(*model)[var - 1]; },
+                                      [this] (int var, int8_t v) { (*model)[var - 1] = (LST)v; });
+
+        checkModel();
 
-        for (const Clause& c: root)
-            if (not someLitTrue(c))
-                printErrorTerm(c);
+        status = SATISFIABLE;
     }
 
+    // Local search from the saved phases, which take its best assignment
+    void walk() {
+
+        Phases& phases = stack.getPhases();
+
+        walker.load([&phases] (int var) { return phases.pick(var - 1); });
+
+        if (walker.walk(walkFlips)) {
+
+            for (LID id = 0; id < numVars; ++id)
+                (*model)[id] = (LST)walker.value((int)id + 1);
+
+            finish();
+            return;
+        }
+
+        walkFlips += walkFlips / 2;
+
+        phases.load(walker.getBest().begin() + 1, walker.getBest().end());
+    }
+
+    // The local search mode: a model, or UNKNOWN after the flip limit. The
+    // walk goes in rounds to notice an interruption.
+    Result runLocalSearch() {
+
+        const uint64_t round = 1 << 20;
+
+        walker.load([] (int) { return (int8_t)0; });
+
+        for (uint64_t done = 0; config.slsFlips == 0 || done < config.slsFlips; done += round) {
+
+            if (interrupted())
+                return UNKNOWN;
+
+            if (walker.walk(config.slsFlips == 0 ? round : std::min(round, config.slsFlips - done))) {
+
+                for (LID id = 0; id < numVars; ++id)
+                    (*model)[id] = (LST)walker.value((int)id + 1);
+
+                finish();
+                return status;
+            }
+        }
+
+        return UNKNOWN;
+    }
+
+    // Next variable to branch on, numVars when all have a value
     LID nextDecision() {
 
-        uint8_t count = 0;
+        VarHeap& order = stack.getOrder();
 
-        LID ret    = 0;
-        double val = 0;
+        // Assigned variables are dropped lazily from the heap
+        while (not order.empty()) {
 
-        for (const Clause &c: root) {
+            LID id = order.popMax();
 
-            if (any_of(c.begin(), c.end(), PL::isTrueS)) continue;
+            // Eliminated variables are not in the formula any more
+            if ((*model)[id] == UNDEF && not formula->preprocessor().isEliminated((int)id + 1))
+                return id;
+        }
 
-            for (const PL &pl: c)
-                if (pl.isUndef() && pl.getValue() >= val) {
+        return numVars;
+    }
 
-                    ret = pl.getId();
-                    val = pl.getValue();
+    // Decide the next assumption, an empty level if it is already true.
+    // False if it is false: the assumptions are refuted.
+    bool decideAssumption() {
 
-                    ++count;
+        L a = assumptions[stack.level()];
 
-                    if (count > 5)
-                        return ret;
-                }
+        if (isFalse(a)) {
+
+            failed = stack.analyzeFinal(ca, *tern, a);
+            return false;
+        }
+
+        if (isTrue(a))
+            stack.newLevel();
+        else
+            stack.setDecision(a.getId(), a.getSt());
+
+        return true;
+    }
+
+    // Back to level 0 after an answer, for more clauses or another call
+    void reopen() {
+
+        // The model of the last call is not on the trail
+        if (status == SATISFIABLE) {
+
+            stack.backjump(0);
+            stack.resetModel();
+
+            status = UNKNOWN;
+        }
+
+        stack.backjump(0);
+
+        failed.clear();
+    }
+
+    // From level 0, decide and propagate every assumption. UNSATISFIABLE if
+    // they are refuted, UNKNOWN once they all hold.
+    Result assumeAll() {
+
+        stack.backjump(0);
+
+        while (true) {
+
+            while (propagate() && status == UNKNOWN);
+
+            if (status != UNKNOWN)
+                return status;
+
+            if (stack.level() >= assumptions.size())
+                return UNKNOWN;
+
+            if (not decideAssumption())
+                return UNSATISFIABLE;
+        }
+    }
+
+    // Assignments implied by l at a new level, undone after. 0 if l fails:
+    // the conflict is then learned and the trail left where it backjumped.
+    size_t probe(L l) {
+
+        uint32_t lvl    = stack.level();
+        size_t   before = stack.assigned();
+
+        stack.setDecision(l.getId(), l.getSt());
+
+        if (propagate())
+            return 0;
+
+        size_t implied = stack.assigned() - before;
+
+        stack.backjump(lvl);
+
+        return implied;
+    }
 
-            if (count != 0)
+    // Lookahead candidates: the free variables with the most binary and
+    // ternary clauses on both sides, a tenth of them and at least 10
+    std::vector<LID> preselect() const {
+
+        std::vector<std::pair<uint64_t, LID>> ranked;
+
+        for (LID id = 0; id < numVars; ++id) {
+
+            if ((*model)[id] != UNDEF || formula->preprocessor().isEliminated((int)id + 1))
                 continue;
 
-            std::cout << "Unexpected error" << std::endl;
-            exit(-3);
+            uint32_t pos = L(id, TRUE).index();
+            uint32_t neg = L(id, FALSE).index();
+
+            uint64_t wp = 2 * binWatches[pos].size() + ternWatches[pos].size();
+            uint64_t wn = 2 * binWatches[neg].size() + ternWatches[neg].size();
+
+            ranked.emplace_back(wp * wn + wp + wn, id);
         }
 
-        if (count != 0)
-            return ret;
+        size_t keep = std::min(ranked.size(), std::max<size_t>(10, ranked.size() / 10));
 
-        //no UNDEF lit found: terminate program
+        std::nth_element(ranked.begin(), ranked.begin() + (long)keep, ranked.end(), std::greater<>());
 
-        checkModel();
-        exit(printSat());
+        std::vector<LID> candidates;
+
+        for (size_t i = 0; i < keep; ++i)
+            candidates.push_back(ranked[i].second);
+
+        return candidates;
     }
 
     void makeDecision() {
 
         LID id = nextDecision();
 
-        stack.setDecision(id, TRUE);
+        // No variable left: a model
+        if (id == numVars) {
+
+            finish();
+            return;
+        }
+
+        ++decisions;
+
+        stack.setDecision(id, (LST)stack.getPhases().pick(id));
 
         //std::cout << id << stateToSymbol(stack.getModel()[id]) << std::endl;
     }
 
 public:
 
-    Problem() : numVars(), numClauses(), stack(0), conClauses() {
+    explicit Problem(const Formula& formula, const ProblemConfig& config = ProblemConfig())
+            : formula(nullptr), tern(nullptr), stack(0), stop(nullptr), exchange(nullptr), worker(0),
+              learnLength(0) {
+
+        reset(formula, config);
+    }
+
+    Problem(const Problem&) = delete;
+    Problem& operator = (const Problem&) = delete;
+
+    // Start over on another formula. The watch lists and the clause arena
+    // keep their memory, so a Problem solving many formulas in turn stops
+    // allocating once it has seen the largest. The interruption flag and the
+    // incremental hooks stay, clause sharing does not: share() again if needed.
+    void reset(const Formula& f, const ProblemConfig& c = ProblemConfig()) {
+
+        formula = &f;
+        tern    = &f.ternaries();
+        config  = c;
+
+        simplified   = 0;
+        conflicts    = 0;
+        decisions    = 0;
+        propagations = 0;
+        restart      = Restart(config.restart);
+        numVars      = formula->vars();
+        numClauses   = formula->getClauses().size();
+        nextSubsume  = config.subsumeInterval;
+        walkFlips    = 0;
+        status       = UNKNOWN;
+        exchange     = nullptr;
+        worker       = 0;
+
+        assumptions.clear();
+        failed.clear();
+
+        conClauses.clear();
+
+        ca.clear();
+        root.clear();
+
+        stack.reset(numVars, config.phases, config.polarity);
+
+        model = &stack.getModel();
+
+        recycle(binWatches);
+        recycle(ternWatches);
+        recycle(watches);
 
-        // Skip comments
-        char c;
-        std::cin >> c;
-        while (c == 'c') {
-            while (c != '\n')
-                std::cin >> c;
-            std::cin >> c;
+        if (formula->isUnsat()) {
+
+            status = UNSATISFIABLE;
+            return;
         }
 
-        std::string aux;
-        std::cin >> aux >> numVars >> numClauses;
+        const Arena& fa = formula->arena();
+
+        if (config.mode == ProblemConfig::SLS || config.phases.walks()) {
 
-        stack = DStack(numVars);
+            walker = LocalSearch((int)numVars, config.phases.seed);
 
-        root = std::vector<Clause>(numClauses, Clause());
+            std::vector<int> cl;
 
-        // Read clauses
-        for (uint i = 0; i < numClauses; ++i) {
+            for (CRef cr: formula->getClauses()) {
 
-            int lit;
+                cl.clear();
 
-            while (std::cin >> lit and lit != 0) {
+                for (const L* l = fa.begin(cr); l != fa.end(cr); ++l)
+                    cl.push_back(l->getSt() == TRUE ? (int)l->getId() + 1 : -(int)l->getId() - 1);
 
-                if (lit > 0)
-                    root[i].emplace_back(lit - 1, &stack.getModel()[lit -1], TRUE);
-                else
-                    root[i].emplace_back(-lit -1, &stack.getModel()[-lit -1], FALSE);
+                walker.addClause(cl);
             }
+
+            walkFlips = config.walkEffort * std::max<uint64_t>(numClauses, 1);
         }
 
-        cLitTrue  = std::vector<std::list<Clause*>>(numVars);
-        cLitFalse = std::vector<std::list<Clause*>>(numVars);
+        // Binary and ternary clauses get their own watch lists, the long ones a copy in ca
+        TRef t = 0;
 
-        std::fill(cLitTrue.begin(), cLitTrue.end(), std::list<Clause*>());
-        std::fill(cLitFalse.begin(), cLitFalse.end(), std::list<Clause*>());
+        for (CRef cr: formula->getClauses()) {
 
-        for (Clause& cl: root)
-            for (const PL& l: cl)
-                if (l.getSt() == TRUE)
-                    cLitTrue[l.getId()].push_back(&cl);
-                else
-                    cLitFalse[l.getId()].push_back(&cl);
+            const L* cl = fa.begin(cr);
 
-        check = &stack.getQueue();
-        model = &stack.getModel();
+            switch (fa.size(cr)) {
+
+                case 1:
+
+                    // Initial unit clauses are level 0 assignments
+                    if (isFalse(cl[0])) {
 
-        compPriority();
+                        status = UNSATISFIABLE;
+                        return;
+                    }
+
+                    if ((*model)[cl[0].getId()] == UNDEF)
+                        stack.registerProp(cl[0].getId(), cl[0].getSt(), Reason());
+
+                    break;
+                case 2:
+                    addBinary(cl[0], cl[1]);
+                    break;
+                case 3:
+                    watchTernary(t++);
+                    break;
+                default:
+                    root.push_back(ca.alloc(cl, fa.end(cr), false));
+                    attach(root.back());
+            }
+        }
     }
 
-    [[noreturn]] void run() {
+    // Give up with UNKNOWN once flag is set, checked between decisions
+    void interruptOn(const std::atomic<bool>& flag) {
 
-        while (true) {
+        stop = &flag;
+    }
+
+    // Publish short learned clauses to exchange and take those of the other
+    // workers, this one being worker id
+    void share(ClauseExchange& ex, size_t id) {
+
+        exchange = &ex;
+        worker   = id;
+    }
+
+    // A model if one extends the assumptions, UNSATISFIABLE if none does,
+    // UNKNOWN when interrupted or after maxConflicts more conflicts (0 for
+    // no limit). Learned clauses, activities and phases carry over to the
+    // next call: isUnsat() tells a refuted formula from refuted assumptions.
+    Result solve(const std::vector<L>& assume = std::vector<L>(), uint64_t maxConflicts = 0) {
+
+        if (status == UNSATISFIABLE)
+            return status;
+
+        reopen();
+
+        assumptions = assume;
+
+        if (config.mode == ProblemConfig::SLS)
+            return runLocalSearch();
+
+        const uint64_t limit = maxConflicts == 0 ? UINT64_MAX : conflicts + maxConflicts;
+
+        // Satisfiable random instances are often solved before any search.
+        // Local search ignores assumptions.
+        if (config.phases.walks() && assumptions.empty())
+            walk();
+
+        while (status == UNKNOWN) {
+
+            while (propagate() && status == UNKNOWN);
 
-            while (propagate());
+            if (status != UNKNOWN || interrupted() || conflicts >= limit)
+                break;
+
+            // Learned clauses and activities are kept, only the trail goes
+            if (restart.shouldRestart()) {
+
+                stack.backjump(0);
+                restart.restarted();
+            }
+
+            if (stack.getPhases().due(conflicts) && stack.getPhases().rephase() == Phases::WALK &&
+                assumptions.empty()) {
+
+                walk();
+
+                if (status != UNKNOWN)
+                    break;
+            }
+
+            if (stack.end())
+                simplify();
+
+            if (stack.end() && exchange != nullptr) {
+
+                importClauses();
+
+                if (status != UNKNOWN)
+                    break;
+
+                if (stack.hasPending())
+                    continue;
+            }
+
+            if (stack.end() && config.subsumeInterval != 0 && conflicts >= nextSubsume) {
+
+                subsumeLearnts();
+
+                if (status != UNKNOWN)
+                    break;
+
+                // Units found by strengthening
+                if (stack.hasPending())
+                    continue;
+            }
+
+            if (conClauses.due(conflicts))
+                reduceDB();
+
+            // The assumptions are the first decisions
+            if (stack.level() < assumptions.size()) {
+
+                if (not decideAssumption())
+                    return UNSATISFIABLE;
+
+                continue;
+            }
 
             makeDecision();
         }
+
+        return status;
+    }
+
+    // Lookahead under the cube: best is set to the decision that shrinks the
+    // formula most on both branches, by propagating each value of the most
+    // constrained free variables. Failed literals are learned on the way.
+    // UNSATISFIABLE if the cube is refuted (isUnsat() if the formula is),
+    // SATISFIABLE if every variable got a value.
+    Result branch(const std::vector<L>& cube, L& best) {
+
+        if (status == UNSATISFIABLE)
+            return status;
+
+        reopen();
+
+        assumptions = cube;
+
+        while (true) {
+
+            Result res = assumeAll();
+
+            if (res != UNKNOWN)
+                return res;
+
+            std::vector<LID> candidates = preselect();
+
+            if (candidates.empty()) {
+
+                finish();
+                return status;
+            }
+
+            uint64_t bestRank = 0;
+            bool     learned  = false;
+
+            for (LID id: candidates) {
+
+                size_t d0 = probe(L(id, TRUE));
+
+                if (d0 == 0) {
+                    learned = true;
+                    break;
+                }
+
+                size_t d1 = probe(L(id, FALSE));
+
+                if (d1 == 0) {
+                    learned = true;
+                    break;
+                }
+
+                uint64_t rank = 1024 * (uint64_t)d0 * d1 + d0 + d1;
+
+                if (rank >= bestRank) {
+
+                    bestRank = rank;
+
+                    // The side that propagates less first, as in the DPLL lookahead
+                    best = L(id, d0 <= d1 ? TRUE : FALSE);
+                }
+            }
+
+            // A failed literal left a learned clause: look again from the cube
+            if (not learned)
+                return UNKNOWN;
+        }
+    }
+
+    // The formula itself is unsatisfiable, whatever the assumptions
+    [[nodiscard]] inline bool isUnsat() const {
+
+        return status == UNSATISFIABLE;
+    }
+
+    // Incremental use: add a clause between two calls, on variables past
+    // vars() too. Duplicate literals are merged and tautologies dropped.
+    void addClause(std::vector<L> lits) {
+
+        if (status == UNSATISFIABLE)
+            return;
+
+        reopen();
+
+        std::sort(lits.begin(), lits.end(), [] (const L& a, const L& b) { return a.index() < b.index(); });
+
+        lits.erase(std::unique(lits.begin(), lits.end(), [] (const L& a, const L& b) {
+
+            return a.index() == b.index();
+        }), lits.end());
+
+        if (not lits.empty())
+            grow(lits.back().getId() + 1);
+
+        for (size_t i = 1; i < lits.size(); ++i)
+            if (lits[i].getId() == lits[i - 1].getId())
+                return;
+
+        CRef cr = addRootClause(lits, false);
+
+        if (cr != CRef_Undef)
+            root.push_back(cr);
+    }
+
+    // Room for num variables, unassigned
+    void grow(LID num) {
+
+        if (num <= numVars)
+            return;
+
+        numVars = num;
+
+        stack.grow(num);
+
+        binWatches.resize(2 * (size_t)num);
+        ternWatches.resize(2 * (size_t)num);
+        watches.resize(2 * (size_t)num);
+    }
+
+    // Incremental use: give up with UNKNOWN once f() is true, asked between decisions
+    void terminateWhen(std::function<bool()> f) {
+
+        terminate = std::move(f);
+    }
+
+    // Incremental use: f(lits) on every learned clause of at most maxLength literals
+    void onLearn(size_t maxLength, std::function<void(const std::vector<L>&)> f) {
+
+        learnLength = maxLength;
+        learnHook   = std::move(f);
+    }
+
+    // Value in the model of the last call that found one
+    [[nodiscard]] inline LST getValue(LID id) const {
+
+        return id < numVars ? (*model)[id] : UNDEF;
+    }
+
+    // When the last call refuted its assumptions: some of them that are enough for it
+    [[nodiscard]] inline const std::vector<L>& getFailed() const {
+
+        return failed;
+    }
+
+    [[nodiscard]] inline LID vars() const {
+
+        return numVars;
+    }
+
+    [[nodiscard]] inline uint64_t getConflicts() const {
+
+        return conflicts;
+    }
+
+    [[nodiscard]] inline uint64_t getDecisions() const {
+
+        return decisions;
+    }
+
+    [[nodiscard]] inline uint64_t getPropagations() const {
+
+        return propagations;
     }
 };
 
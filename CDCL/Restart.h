@@ -0,0 +1,152 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_RESTART_H
+
+#include <algorithm>
+#include <cstdint>
+
+// When to abandon the current trail and restart from level 0.
+//
+//   LUBY:    after luby(i) * unit conflicts for the i-th restart
+//   GLUCOSE: when the recent LBDs (fast moving average) are worse than the
+//            long term ones (slow moving average), unless the trail is much
+//            longer than usual, which suggests the solver is close to a model
+class Restart {
+
+public:
+
+    enum Policy {
+        NONE,
+        LUBY,
+        GLUCOSE
+    };
+
+private:
+
+    // Exponential moving average, with a larger step while few values were seen
+    class Ema {
+
+    private:
+
+        double value;
+        double alpha;
+        double step;
+
+    public:
+
+        inline explicit Ema(double alpha) : value(0), alpha(alpha), step(1) {}
+
+        inline void update(double x) {
+
+            value += step * (x - value);
+
+            step = std::max(alpha, step / (1 + step));
+        }
+
+        [[nodiscard]] inline double get() const {
+
+            return value;
+        }
+    };
+
+    Policy policy;
+
+    uint64_t conflicts;
+    uint64_t sinceRestart;
+
+    // Luby
+    uint64_t unit;
+    uint64_t restarts;
+    uint64_t limit;
+
+    // Glucose
+    Ema fastLbd;
+    Ema slowLbd;
+    Ema trailSize;
+
+    double   margin;
+    double   blockMargin;
+    uint64_t minConflicts;
+    uint64_t blockAfter;
+
+    // luby(i): 1 1 2 1 1 2 4 1 1 2 1 1 2 4 8 ...
+    [[nodiscard]] static uint64_t luby(uint64_t i) {
+
+        uint64_t size = 1;
+        uint64_t seq  = 0;
+
+        while (size < i + 1) {
+            ++seq;
+            size = 2 * size + 1;
+        }
+
+        while (size - 1 != i) {
+
+            size = (size - 1) / 2;
+            --seq;
+
+            i %= size;
+        }
+
+        return (uint64_t)1 << seq;
+    }
+
+public:
+
+    explicit Restart(Policy policy = GLUCOSE)
+            : policy(policy), conflicts(0), sinceRestart(0),
+              unit(100), restarts(0), limit(100),
+              fastLbd(1.0 / 32), slowLbd(1.0 / 4096), trailSize(1.0 / 5000),
+              margin(1.25), blockMargin(1.4), minConflicts(50), blockAfter(10000) {}
+
+    // After every conflict: LBD of the learned clause and trail size at the conflict
+    void onConflict(uint32_t lbd, size_t trail) {
+
+        ++conflicts;
+        ++sinceRestart;
+
+        if (policy != GLUCOSE)
+            return;
+
+        fastLbd.update(lbd);
+        slowLbd.update(lbd);
+
+        // Blocking: an unusually long trail postpones the next restart
+        if (conflicts > blockAfter && sinceRestart >= minConflicts &&
+            (double)trail > blockMargin * trailSize.get())
+            sinceRestart = 0;
+
+        trailSize.update((double)trail);
+    }
+
+    [[nodiscard]] bool shouldRestart() const {
+
+        switch (policy) {
+
+            case LUBY:
+                return sinceRestart >= limit;
+            case GLUCOSE:
+                return sinceRestart >= minConflicts && fastLbd.get() > margin * slowLbd.get();
+            default:
+                return false;
+        }
+    }
+
+    void restarted() {
+
+        sinceRestart = 0;
+
+        limit = unit * luby(++restarts);
+    }
+
+    [[nodiscard]] inline uint64_t getRestarts() const {
+
+        return restarts;
+    }
+};
+
+#define LI_SAT_SOLVER_RESTART_H
+
+#endif //LI_SAT_SOLVER_RESTART_H
@@ -0,0 +1,164 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_VARHEAP_H
+
+#include "satBasicDef.h"
+#include <vector>
+
+// Variable activities (EVSIDS) and a binary max heap over them, indexed by variable
+class VarHeap {
+
+private:
+
+    std::vector<double>  activity;
+    std::vector<LID>     heap;
+    std::vector<int64_t> pos;
+
+    double inc;
+    double decayF;
+
+    [[nodiscard]] inline bool above(LID a, LID b) const {
+
+        return activity[a] > activity[b];
+    }
+
+    void up(size_t i) {
+
+        LID id = heap[i];
+
+        while (i > 0 && above(id, heap[(i - 1) / 2])) {
+
+            heap[i] = heap[(i - 1) / 2];
+            pos[heap[i]] = (int64_t)i;
+
+            i = (i - 1) / 2;
+        }
+
+        heap[i] = id;
+        pos[id] = (int64_t)i;
+    }
+
+    void down(size_t i) {
+
+        LID id = heap[i];
+
+        while (2 * i + 1 < heap.size()) {
+
+            size_t child = 2 * i + 1;
+
+            if (child + 1 < heap.size() && above(heap[child + 1], heap[child]))
+                ++child;
+
+            if (not above(heap[child], id))
+                break;
+
+            heap[i] = heap[child];
+            pos[heap[i]] = (int64_t)i;
+
+            i = child;
+        }
+
+        heap[i] = id;
+        pos[id] = (int64_t)i;
+    }
+
+public:
+
+    explicit VarHeap(LID num, double decay = 0.95) : inc(1), decayF(decay) {
+
+        activity = std::vector<double>(num, 0);
+        pos      = std::vector<int64_t>(num, -1);
+
+        heap.reserve(num);
+
+        for (LID id = 0; id < num; ++id)
+            insert(id);
+    }
+
+    // Variables 0 to num - 1 with no activity, over the memory already allocated
+    void reset(LID num) {
+
+        inc = 1;
+
+        activity.assign(num, 0);
+        pos.assign(num, -1);
+        heap.clear();
+
+        for (LID id = 0; id < num; ++id)
+            insert(id);
+    }
+
+    // New variables up to num, with no activity yet
+    void grow(LID num) {
+
+        for (auto id = (LID)activity.size(); id < num; ++id) {
+
+            activity.push_back(0);
+            pos.push_back(-1);
+
+            insert(id);
+        }
+    }
+
+    [[nodiscard]] inline bool contains(LID id) const {
+
+        return pos[id] >= 0;
+    }
+
+    [[nodiscard]] inline bool empty() const {
+
+        return heap.empty();
+    }
+
+    inline void insert(LID id) {
+
+        if (contains(id))
+            return;
+
+        heap.push_back(id);
+        up(heap.size() - 1);
+    }
+
+    LID popMax() {
+
+        LID top = heap[0];
+
+        heap[0] = heap.back();
+        heap.pop_back();
+
+        pos[top] = -1;
+
+        if (not heap.empty())
+            down(0);
+
+        return top;
+    }
+
+    // Raise the activity of id by the current increment
+    void bump(LID id) {
+
+        if ((activity[id] += inc) > 1e100) {
+
+            // Rescale everything, the order is unchanged
+            for (double& a: activity)
+                a *= 1e-100;
+
+            inc *= 1e-100;
+        }
+
+        if (contains(id))
+            up(pos[id]);
+    }
+
+    // Exponential decay: future bumps weigh more than past ones
+    inline void decay() {
+
+        inc /= decayF;
+    }
+};
+
+#define LI_SAT_SOLVER_VARHEAP_H
+
+#endif //LI_SAT_SOLVER_VARHEAP_H
@@ -0,0 +1,154 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#include "ipasir.h"
+#include "Problem.h"
+
+// One incremental solver: a Problem on an empty Formula, fed clause by
+// clause. The preprocessor and local search stay off, eliminated variables
+// could come back in a later clause and walks would not see added clauses.
+struct IpasirSolver {
+
+    Formula formula;
+    Problem problem;
+
+    std::vector<L> clause;
+    std::vector<L> assumptions;
+
+    // Per variable, one bit per value: among the failed assumptions of the last call
+    std::vector<char> failed;
+
+    std::vector<int32_t> learnt;
+
+    IpasirSolver() : problem(formula) {}
+
+    [[nodiscard]] static inline L toLit(int32_t lit) {
+
+        return lit > 0 ? L((LID)lit - 1, TRUE) : L((LID)-lit - 1, FALSE);
+    }
+};
+
+extern "C" {
+
+const char* ipasir_signature() {
+
+    return "LI_SAT_solver cdcl";
+}
+
+void* ipasir_init() {
+
+    return new IpasirSolver();
+}
+
+void ipasir_release(void* solver) {
+
+    delete (IpasirSolver*)solver;
+}
+
+void ipasir_add(void* solver, int32_t lit_or_zero) {
+
+    auto* s = (IpasirSolver*)solver;
+
+    if (lit_or_zero != 0) {
+
+        s->clause.push_back(IpasirSolver::toLit(lit_or_zero));
+        return;
+    }
+
+    s->problem.addClause(s->clause);
+    s->clause.clear();
+}
+
+void ipasir_assume(void* solver, int32_t lit) {
+
+    auto* s = (IpasirSolver*)solver;
+
+    L l = IpasirSolver::toLit(lit);
+
+    // Unseen variables get created, not guessed
+    s->problem.grow(l.getId() + 1);
+    s->assumptions.push_back(l);
+}
+
+int ipasir_solve(void* solver) {
+
+    auto* s = (IpasirSolver*)solver;
+
+    Result res = s->problem.solve(s->assumptions);
+
+    s->assumptions.clear();
+
+    s->failed.assign(s->problem.vars(), 0);
+
+    for (const L& l: s->problem.getFailed())
+        s->failed[l.getId()] |= l.getSt() == TRUE ? 1 : 2;
+
+    switch (res) {
+
+        case SATISFIABLE:
+            return 10;
+        case UNSATISFIABLE:
+            return 20;
+        default:
+            return 0;
+    }
+}
+
+int32_t ipasir_val(void* solver, int32_t lit) {
+
+    auto* s = (IpasirSolver*)solver;
+
+    L l = IpasirSolver::toLit(lit);
+
+    LST v = s->problem.getValue(l.getId());
+
+    if (v == UNDEF)
+        return 0;
+
+    return v == l.getSt() ? lit : -lit;
+}
+
+int ipasir_failed(void* solver, int32_t lit) {
+
+    auto* s = (IpasirSolver*)solver;
+
+    L l = IpasirSolver::toLit(lit);
+
+    return l.getId() < s->failed.size() && (s->failed[l.getId()] & (l.getSt() == TRUE ? 1 : 2)) != 0;
+}
+
+void ipasir_set_terminate(void* solver, void* data, int (*terminate)(void* data)) {
+
+    auto* s = (IpasirSolver*)solver;
+
+    if (terminate == nullptr)
+        s->problem.terminateWhen(nullptr);
+    else
+        s->problem.terminateWhen([data, terminate] () { return terminate(data) != 0; });
+}
+
+void ipasir_set_learn(void* solver, void* data, int max_length, void (*learn)(void* data, int32_t* clause)) {
+
+    auto* s = (IpasirSolver*)solver;
+
+    if (learn == nullptr) {
+
+        s->problem.onLearn(0, nullptr);
+        return;
+    }
+
+    s->problem.onLearn((size_t)std::max(max_length, 0), [s, data, learn] (const std::vector<L>& lits) {
+
+        s->learnt.clear();
+
+        for (const L& l: lits)
+            s->learnt.push_back(l.getSt() == TRUE ? (int32_t)l.getId() + 1 : -(int32_t)l.getId() - 1);
+
+        s->learnt.push_back(0);
+
+        learn(data, s->learnt.data());
+    });
+}
+
+}
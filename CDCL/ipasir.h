@@ -0,0 +1,55 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_IPASIR_H
+
+#include <stdint.h>
+
+// IPASIR: the incremental SAT solver interface of the SAT competitions.
+// Literals are DIMACS integers (var or -var), variables are created when
+// first used. Learned clauses, activities and phases are kept from one
+// ipasir_solve() to the next.
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Name and version of the solver
+const char* ipasir_signature();
+
+// A new solver with no clauses
+void* ipasir_init();
+
+void ipasir_release(void* solver);
+
+// Add a literal to the clause being built, 0 ends the clause
+void ipasir_add(void* solver, int32_t lit_or_zero);
+
+// Assume lit for the next ipasir_solve() only
+void ipasir_assume(void* solver, int32_t lit);
+
+// 10 satisfiable, 20 unsatisfiable under the assumptions, 0 interrupted
+int ipasir_solve(void* solver);
+
+// After 10: lit if lit is true in the model, -lit if false, 0 for a
+// variable the solver never saw
+int32_t ipasir_val(void* solver, int32_t lit);
+
+// After 20: 1 if assumption lit was used to refute the assumptions
+int ipasir_failed(void* solver, int32_t lit);
+
+// ipasir_solve() gives up with 0 once terminate(data) returns non zero
+void ipasir_set_terminate(void* solver, void* data, int (*terminate)(void* data));
+
+// learn(data, clause) on every learned clause up to max_length literals,
+// clause being zero terminated
+void ipasir_set_learn(void* solver, void* data, int max_length, void (*learn)(void* data, int32_t* clause));
+
+#ifdef __cplusplus
+}
+#endif
+
+#define LI_SAT_SOLVER_IPASIR_H
+
+#endif //LI_SAT_SOLVER_IPASIR_H
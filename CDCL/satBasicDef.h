@@ -13,7 +13,15 @@ enum LST : int8_t {
     TRUE = 1
 };
 
-typedef uint16_t LID;
+// Answer of a search
+enum Result : int8_t {
+    UNKNOWN,
+    SATISFIABLE,
+    UNSATISFIABLE
+};
+
+// Variable id, below 2^31 so that literal codes fit 32 bits
+typedef uint32_t LID;
 
 static std::string stateToSymbol(LST st) {
 
@@ -29,45 +37,58 @@ static std::string stateToSymbol(LST st) {
     }
 }
 
+// Literal as a 32-bit code: 2 * id + (st == TRUE)
 class L {
 
 private:
 
-    LID id;
-    LST st;
+    uint32_t x;
+
+    inline explicit L(uint32_t x) : x(x) {}
 
 public:
 
-    inline L(LID id, LST st) : id(id), st(st) {}
+    inline L(LID id, LST st) : x(2 * (uint32_t)id + (st == TRUE)) {}
 
     [[nodiscard]] inline LID getId() const {
 
-        return id;
+        return x >> 1;
     }
 
     [[nodiscard]] inline LST getSt() const {
 
-        return st;
+        return x & 1 ? TRUE : FALSE;
     }
 
     inline void reverse() {
 
-        st = (LST)(-st);
+        x ^= 1;
     }
 
     inline void set(LST s) {
 
-        st = s;
+        x = (x & ~1u) | (s == TRUE);
+    }
+
+    // Position of the literal in literal-indexed tables (watch lists)
+    [[nodiscard]] inline uint32_t index() const {
+
+        return x;
+    }
+
+    [[nodiscard]] inline static L fromIndex(uint32_t i) {
+
+        return L(i);
     }
 
     inline bool operator == (const L& l) const {
 
-        return id == l.id;
+        return getId() == l.getId();
     }
 
     inline bool operator < (const L& l) const {
 
-        return id < l.id;
+        return getId() < l.getId();
     }
 
     friend  std::ostream& operator << (std::ostream& os, const L& lit);
@@ -75,7 +96,7 @@ public:
 
 std::ostream& operator << (std::ostream& os, const L& lit) {
 
-    return os << stateToSymbol(lit.st) << lit.id;
+    return os << stateToSymbol(lit.getSt()) << lit.getId();
 }
 
 std::ostream& operator << (std::ostream& os, const LST& st) {
@@ -83,65 +104,6 @@ std::ostream& operator << (std::ostream& os, const LST& st) {
     return os << stateToSymbol(st);
 }
 
-class PL {
-
-private:
-
-    float val;
-    LID   id;
-    LST*  ref;
-    LST   st;
-
-public:
-
-    inline PL() : id(), ref(&st), st(), val(0) {}
-
-    inline PL(LID id, LST *ref, LST st) : id(id), ref(ref), val(0), st(st) {}
-
-    [[nodiscard]] inline bool isTrue() const {
-
-        return *ref == st;
-    }
-
-    [[nodiscard]] inline static bool isTrueS(const PL& pl) {
-
-        return *pl.ref == pl.st;
-    }
-
-    [[nodiscard]] inline static bool isFalseS(const PL& pl) {
-
-        if (*pl.ref == UNDEF)
-            return false;
-
-        return *pl.ref != pl.st;
-    }
-
-    [[nodiscard]] inline bool isUndef() const {
-
-        return *ref == UNDEF;
-    }
-
-    [[nodiscard]] inline LST getSt() const {
-
-        return st;
-    }
-
-    [[nodiscard]] inline LID getId() const {
-
-        return id;
-    }
-
-    [[nodiscard]] inline float getValue() const {
-
-        return val;
-    }
-
-    inline void setValue(float v) {
-
-        val = v;
-    }
-};
-
 #define LI_SAT_SOLVER_VDEF_H
 
 #endif //LI_SAT_SOLVER_VDEF_H
@@ -3,10 +3,180 @@
 //
 
 #include "Problem.h"
+#include "Portfolio.h"
+#include "CubeAndConquer.h"
+#include "../common/Batch.h"
+#include "../common/Options.h"
+#include <memory>
 
-int main() {
+// Exit code of the answer, after printing it
+static int printResult(Result res) {
 
-    Problem a = Problem();
+    switch (res) {
 
-    a.run();
-}
\ No newline at end of file
+        case SATISFIABLE:
+            std::cout << "SATISFIABLE" << ' ' << std::endl;
+            return 20;
+        case UNSATISFIABLE:
+            std::cout << "UNSATISFIABLE" << ' ' << std::endl;
+            return 10;
+        default:
+            std::cout << "UNKNOWN" << ' ' << std::endl;
+            return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+
+    Options opts = Options(argc, argv);
+
+    ProblemConfig config;
+
+    // Cube and conquer drives CDCL Problems
+    size_t mode = opts.choice("mode", {"cdcl", "sls", "cube"}, 0);
+
+    config.mode     = mode == 1 ? ProblemConfig::SLS : ProblemConfig::CDCL;
+    config.slsFlips = (uint64_t)std::max(0LL, opts.getInt("sls-flips", 0));
+
+    config.restart = (Restart::Policy)opts.choice("restart", {"none", "luby", "glucose"}, Restart::GLUCOSE);
+    config.phases  = Phases::fromOptions(opts, "original,best,walk,inverted,best,walk,random,best,walk");
+
+    config.walkEffort = (uint64_t)std::max(0LL, opts.getInt("walk-effort", 100));
+
+    config.preprocess.subsume = opts.getInt("subsume", 1) != 0;
+    config.preprocess.probe   = opts.getInt("probe", 1) != 0;
+    config.preprocess.elim    = opts.getInt("elim", 1) != 0;
+
+    config.subsumeInterval = (uint64_t)std::max(0LL, opts.getInt("subsume-interval", 5000));
+
+    config.exportLbd = (uint32_t)std::max(0LL, opts.getInt("export-lbd", 2));
+
+    // Batch mode: every file, directory and @list given, --timeout seconds each.
+    // --threads is then the number of instances solved at once, each by a
+    // single-threaded Problem (0 for one per hardware thread), instead of the
+    // portfolio size. Cube and conquer is not available there
+    bool      batchMode = opts.getInt("batch", 0) != 0;
+    long long threads   = opts.getInt("threads", batchMode ? 0 : 1);
+    double    timeout   = std::max(0.0, opts.getDouble("timeout", 0));
+
+    // Cube and conquer: depth of the cubes (0 for automatic), conflicts per cube
+    auto depth      = (uint32_t)std::max(0LL, opts.getInt("cube-depth", 0));
+    auto budget     = (uint64_t)std::max(1LL, opts.getInt("cube-conflicts", 5000));
+    bool cubeReport = opts.getInt("cube-report", 1) != 0;
+
+    // Search counters as comment lines, before the answer; with a portfolio,
+    // the worker that answered
+    bool stats = opts.getInt("stats", 0) != 0;
+
+    opts.rejectUnknown();
+
+    if (batchMode && mode == 2) {
+
+        std::cerr << "c --mode=cube does not combine with --batch" << std::endl;
+        return 1;
+    }
+
+    if (batchMode) {
+
+        std::vector<std::string> paths;
+        std::string              error;
+
+        if (not Batch::expand(opts.getPositional(), paths, error)) {
+
+            std::cerr << "c " << error << std::endl;
+            return 1;
+        }
+
+        Batch batch = Batch(paths, (size_t)std::max(0LL, threads), timeout);
+
+        // Created on the first instance of each worker, reset on the next ones
+        std::vector<std::unique_ptr<Problem>> problems(batch.getWorkers());
+
+        batch.run(std::cout, "conflicts", [&problems, &config] (size_t w, const std::string& path,
+                                                                const std::function<bool()>& expired) {
+
+            Formula formula = Formula(path, config.preprocess);
+
+            std::unique_ptr<Problem>& problem = problems[w];
+
+            if (problem == nullptr)
+                problem = std::make_unique<Problem>(formula, config);
+            else
+                problem->reset(formula, config);
+
+            problem->terminateWhen(expired);
+
+            Result res = problem->solve();
+
+            return Batch::Outcome{res, problem->getConflicts()};
+        });
+
+        return 0;
+    }
+
+    // Portfolio workers, 0 for one per hardware thread
+    if (threads <= 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+
+    // DIMACS file, stdin if none
+    std::string path = opts.getPositional().empty() ? "" : opts.getPositional()[0];
+
+    std::unique_ptr<Formula> input;
+
+    try {
+
+        input = std::make_unique<Formula>(path, config.preprocess);
+    }
+    catch (const DimacsReader::Error& e) {
+
+        std::cerr << "c " << e.what() << std::endl;
+        return 1;
+    }
+
+    const Formula& formula = *input;
+
+    if (mode == 2) {
+
+        CubeAndConquer cc = CubeAndConquer(formula, config, (size_t)threads, depth, budget);
+
+        Result res = cc.solve();
+
+        if (cubeReport)
+            cc.printReport(std::cout);
+
+        return printResult(res);
+    }
+
+    if (threads == 1) {
+
+        Problem a = Problem(formula, config);
+
+        Result res = a.solve();
+
+        if (stats) {
+
+            std::cout << "c conflicts " << a.getConflicts() << std::endl
+                      << "c decisions " << a.getDecisions() << std::endl
+                      << "c propagations " << a.getPropagations() << std::endl;
+
+            formula.preprocessor().printStats(std::cout);
+        }
+
+        return printResult(res);
+    }
+
+    Portfolio portfolio = Portfolio(formula, config, (size_t)threads);
+
+    Result res = portfolio.solve();
+
+    // The worker that answered, in the order of Portfolio::diversify()
+    if (stats) {
+
+        if (res != UNKNOWN)
+            std::cout << "c winner " << portfolio.getWinner() << std::endl;
+
+        formula.preprocessor().printStats(std::cout);
+    }
+
+    return printResult(res);
+}
@@ -0,0 +1,1456 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_DPLL_H
+
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include "../common/ClauseArena.h"
+#include "../common/Dimacs.h"
+#include "../common/LocalSearch.h"
+#include "../common/Phase.h"
+#include "../common/Preprocess.h"
+
+enum LST : int8_t {
+    FALSE = -1,
+    UNDEF = 0,
+    TRUE = 1
+};
+
+// Variable id, below 2^31 so that literal codes fit 32 bits
+typedef uint32_t LID;
+
+// Literal as a 32-bit code: 2 * id + (state == TRUE). Id 0 is the decision
+// marker of modelStack, its state is UNDEF
+class Lit {
+
+private:
+
+    uint32_t x;
+
+public:
+
+    inline Lit(LID id, LST st) : x(2 * (uint32_t)id + (st == TRUE)) {}
+
+    [[nodiscard]] inline LST state() const {
+        if (getId() == 0)
+            return UNDEF;
+        return x & 1 ? TRUE : FALSE;
+    }
+
+    [[nodiscard]] inline LID getId() const {
+        return x >> 1;
+    }
+
+    // Position of the literal in literal-indexed tables (watch lists)
+    [[nodiscard]] inline uint32_t index() const {
+        return x;
+    }
+
+    inline void reverse() {
+        x ^= 1;
+    }
+};
+
+// View of a clause stored in the arena
+class Clause {
+
+private:
+
+    Lit*     lits;
+    uint32_t n;
+
+public:
+
+    inline Clause(Lit* lits, uint32_t n) : lits(lits), n(n) {}
+
+    [[nodiscard]] inline Lit* begin() const {
+        return lits;
+    }
+
+    [[nodiscard]] inline Lit* end() const {
+        return lits + n;
+    }
+
+    [[nodiscard]] inline uint32_t size() const {
+        return n;
+    }
+
+    [[nodiscard]] inline bool empty() const {
+        return n == 0;
+    }
+
+    inline Lit& operator [] (size_t i) const {
+        return lits[i];
+    }
+};
+
+// Propagation kernels by clause kind, see Dpll::kindGivesConflict(). The
+// same type as in the CDCL engine, the microbenchmarks link both
+enum ClauseKind : uint32_t {
+    BINARY,
+    TERNARY,
+    LONG
+};
+
+// Watch list entry of a ternary clause: its two other literals
+struct TernaryWatch {
+
+    Lit a;
+    Lit b;
+};
+
+enum Result : int8_t {
+    UNKNOWN,
+    SATISFIABLE,
+    UNSATISFIABLE
+};
+
+// Runtime settings of the engine, filled from the command line by main.cpp
+struct DpllConfig {
+
+    // dpll, lookahead: decisions by lookahead, or sls: local search only,
+    // UNKNOWN after slsFlips flips (0 for no limit)
+    enum Mode {
+        DPLL,
+        LOOKAHEAD,
+        SLS
+    };
+
+    Mode mode = DPLL;
+
+    uint64_t slsFlips = 0;
+
+    Phases::Config phases;
+
+    // Flips of the first walk rephase per clause, each walk gets half more than the last
+    uint64_t walkEffort = 100;
+
+    // Resolvents are longer than the clauses they replace, which the
+    // branching scores of this engine do not like: elimination is off unless asked
+    Preprocessor::Passes preprocess = {true, true, false};
+};
+
+// One DPLL search, all of its state in the object: several of them can run
+// in parallel threads, and one of them can solve many formulas in turn,
+// load() after load() reusing the memory of the tables it already has.
+class Dpll {
+
+private:
+
+    // Component microbenchmarks, bench/MicroDpll.cpp
+    friend struct DpllMicro;
+
+    DpllConfig config;
+
+    // Answer so far, UNKNOWN while searching
+    Result status = UNKNOWN;
+
+    // Asked between decisions whether to give up, if set
+    std::function<bool()> terminate;
+
+    uint64_t numClauses;
+    LID numVars;
+
+    ClauseArena<Lit> arena;
+    std::vector<CRef> clauses;
+    std::vector<LST> model;
+    std::vector<Lit> modelStack;
+
+    // Clauses as read, moved out of arena when the preprocessor rewrites the
+    // formula: the final model is checked against them
+    ClauseArena<Lit> input;
+    std::vector<CRef> original;
+
+    // Simplification before search, and model reconstruction after it
+    Preprocessor pre;
+
+    // Per literal l, visited when l becomes false:
+    //   binWatches[l.index()]:  other literal of every binary clause of l
+    //   ternWatches[l.index()]: other literals of every ternary clause of l
+    //   watches[l.index()]:     long clauses watching l
+    // Short clauses stay in the arena as well, for the branching scores.
+    std::vector<std::vector<Lit>> binWatches;
+    std::vector<std::vector<TernaryWatch>> ternWatches;
+    std::vector<std::vector<CRef>> watches;
+
+    std::vector<double> value;
+
+    // Incremental branching scores: log(value[id]) + sum over the clauses of id
+    // of log(1 + 10 * assigned literals of the clause), kept up to date on every
+    // assignment and unassignment for the unassigned variables
+    std::vector<std::vector<uint32_t>> occurs;
+    std::vector<uint32_t> assignedLits;
+    std::vector<double> boostLog;
+    std::vector<double> score;
+
+    // Max heap of candidate variables by score, heapPos[id] < 0 if not in the heap
+    std::vector<LID> heap;
+    std::vector<int64_t> heapPos;
+
+    // Heap entries whose score changed since the last decision
+    std::vector<LID> dirty;
+    std::vector<char> isDirty;
+
+    std::vector<size_t> fixPos;
+    std::vector<char> fixMark;
+
+    // Polarity of the next decision on each variable, saved on backtrack
+    Phases phases = Phases(0, FALSE);
+
+    // Local search over the clauses after preprocessing, for walk rephases and
+    // the local search mode
+    LocalSearch walker;
+    uint64_t walkFlips = 0;
+
+    // Lookahead mode: decisions come from lookahead() instead of the heap, and
+    // the incremental branching scores are not kept
+    bool lookaheadMode = false;
+    Lit laDecision = Lit(0, UNDEF);
+
+    // Preselected variables of the current node, and per literal the weight of
+    // the unsatisfied clauses it occurs in (a clause shrinks when it is false)
+    std::vector<LID> candidates;
+    std::vector<double> laWeight;
+    std::vector<double> laRank;
+
+    // Decision literal of each candidate looked ahead at the node, its rank
+    // in laRank
+    std::vector<Lit> laLooked;
+
+    // Long clauses of each literal, to weigh what a lookahead reduces
+    std::vector<std::vector<CRef>> longOccurs;
+
+    // laShrunk[k]: weight of an unsatisfied clause left with k free literals,
+    // 1 for a binary clause and a fifth of that for every literal more
+    std::vector<double> laShrunk;
+
+    // A lookahead whose reduction exceeds the trigger gets a double lookahead
+    double dlTrigger = 0;
+
+    size_t nextIndex;
+    uint32_t level;
+
+    uint64_t back = 0;
+    uint64_t decisions = 0;
+
+    // Literals whose watches were visited, lookaheads included
+    uint64_t propagations = 0;
+
+    inline Clause clauseAt(CRef cr) {
+
+        return {arena.begin(cr), arena.size(cr)};
+    }
+
+    // 1 true, 0 unassigned, -1 false
+    inline int litValue(Lit l) {
+
+        return model[l.getId()] * l.state();
+    }
+
+    bool watchesGiveConflict(Lit falseLit) {
+
+        std::vector<CRef> &ws = watches[falseLit.index()];
+
+        auto i = ws.begin();
+        auto j = ws.begin();
+
+        while (i != ws.end()) {
+
+            CRef cr = *i++;
+            Clause c = clauseAt(cr);
+
+            // Keep the falsified watch in c[1]
+            if (c[0].index() == falseLit.index())
+                std::swap(c[0], c[1]);
+
+            if (currentModelValue(c[0]) == TRUE) {
+                *j++ = cr;
+                continue;
+            }
+
+            // Look for a new literal to watch
+            bool moved = false;
+
+            for (size_t k = 2; k < c.size(); ++k)
+                if (currentModelValue(c[k]) != FALSE) {
+
+                    std::swap(c[1], c[k]);
+                    watches[c[1].index()].push_back(cr);
+
+                    moved = true;
+                    break;
+                }
+
+            if (moved)
+                continue;
+
+            *j++ = cr;
+
+            if (currentModelValue(c[0]) == FALSE) {
+
+                // Conflict: keep the remaining watches untouched
+                while (i != ws.end())
+                    *j++ = *i++;
+
+                ws.erase(j, ws.end());
+                return true;
+            }
+
+            setLit(c[0]);
+        }
+
+        ws.erase(j, ws.end());
+        return false;
+    }
+
+    // Visit the clauses of kind K of falseLit, which has just become false
+    template <ClauseKind K>
+    bool kindGivesConflict(Lit falseLit) {
+
+        if constexpr (K == BINARY) {
+
+            for (Lit other: binWatches[falseLit.index()]) {
+
+                int v = litValue(other);
+
+                if (v == 0)
+                    setLit(other);
+                else if (v < 0)
+                    return true;
+            }
+
+            return false;
+        }
+
+        if constexpr (K == TERNARY) {
+
+            for (const TernaryWatch& w: ternWatches[falseLit.index()]) {
+
+                int va = litValue(w.a);
+                int vb = litValue(w.b);
+
+                // 0: satisfied or two unassigned literals, 1: unit, 2: falsified
+                int status = ((va != 1) & (vb != 1)) * (2 - (va == 0) - (vb == 0));
+
+                if (status == 0)
+                    continue;
+
+                if (status == 2)
+                    return true;
+
+                setLit(va == 0 ? w.a : w.b);
+            }
+
+            return false;
+        }
+
+        if constexpr (K == LONG)
+            return watchesGiveConflict(falseLit);
+    }
+
+    bool propagateGivesConflict () {
+
+        for (; nextIndex < modelStack.size(); ++nextIndex) {
+
+            Lit l = modelStack[nextIndex];
+
+            if (l.state() == UNDEF)
+                continue;
+
+            ++propagations;
+
+            l.reverse();
+
+            if (kindGivesConflict<BINARY>(l) || kindGivesConflict<TERNARY>(l) || kindGivesConflict<LONG>(l))
+                return true;
+        }
+
+        return false;
+    }
+
+    inline bool heapAbove(LID a, LID b) {
+
+        // Ties go to the lowest id
+        return score[a] > score[b] || (score[a] == score[b] && a < b);
+    }
+
+    void heapDown(size_t i) {
+
+        LID id = heap[i];
+
+        while (2 * i + 1 < heap.size()) {
+
+            size_t child = 2 * i + 1;
+
+            if (child + 1 < heap.size() && heapAbove(heap[child + 1], heap[child]))
+                ++child;
+
+            if (not heapAbove(heap[child], id))
+                break;
+
+            heap[i] = heap[child];
+            heapPos[heap[i]] = (int64_t)i;
+
+            i = child;
+        }
+
+        heap[i] = id;
+        heapPos[id] = (int64_t)i;
+    }
+
+    inline void markDirty(LID id) {
+
+        if (isDirty[id])
+            return;
+
+        isDirty[id] = 1;
+        dirty.push_back(id);
+    }
+
+    void heapInsert(LID id) {
+
+        if (heapPos[id] >= 0)
+            return;
+
+        heapPos[id] = (int64_t)heap.size();
+        heap.push_back(id);
+
+        markDirty(id);
+    }
+
+    // Restore the heap after the scores of the dirty entries changed: sift down
+    // every dirty position and its ancestors, deepest first, as heapify does
+    void heapFix() {
+
+        // Most of the heap changed: plain heapify is cheaper
+        if (4 * dirty.size() > heap.size()) {
+
+            for (LID id: dirty)
+                isDirty[id] = 0;
+
+            dirty.clear();
+
+            for (size_t p = heap.size() / 2; p-- > 0;)
+                heapDown(p);
+
+            return;
+        }
+
+        for (LID id: dirty) {
+
+            isDirty[id] = 0;
+
+            if (heapPos[id] < 0)
+                continue;
+
+            for (size_t p = heapPos[id]; not fixMark[p]; p = (p - 1) / 2) {
+
+                fixMark[p] = 1;
+                fixPos.push_back(p);
+
+                if (p == 0)
+                    break;
+            }
+        }
+
+        dirty.clear();
+
+        std::sort(fixPos.begin(), fixPos.end(), std::greater<>());
+
+        for (size_t p: fixPos) {
+            fixMark[p] = 0;
+            heapDown(p);
+        }
+
+        fixPos.clear();
+    }
+
+    LID heapPop() {
+
+        LID top = heap[0];
+
+        heap[0] = heap.back();
+        heap.pop_back();
+
+        heapPos[top] = -1;
+
+        if (not heap.empty())
+            heapDown(0);
+
+        return top;
+    }
+
+    // The clauses of id gain (delta = 1) or lose (delta = -1) an assigned literal.
+    // Only unassigned variables are kept up to date, see rescore()
+    void updateScores(LID id, int delta) {
+
+        for (uint32_t cid: occurs[id]) {
+
+            uint32_t before = assignedLits[cid];
+            uint32_t after  = assignedLits[cid] += delta;
+
+            double diff = boostLog[after] - boostLog[before];
+
+            for (Lit l: clauseAt(clauses[cid])) {
+
+                LID other = l.getId();
+
+                if (model[other] != UNDEF || other == id)
+                    continue;
+
+                score[other] += diff;
+                markDirty(other);
+            }
+        }
+    }
+
+    // Score of a variable that has just been unassigned
+    void rescore(LID id) {
+
+        double s = log(value[id]);
+
+        for (uint32_t cid: occurs[id])
+            s += boostLog[assignedLits[cid]];
+
+        score[id] = s;
+    }
+
+    LID nextDecision() {
+
+        heapFix();
+
+        // Assigned variables are dropped lazily from the heap
+        while (not heap.empty()) {
+
+            LID id = heapPop();
+
+            if (model[id] == UNDEF)
+                return id;
+        }
+
+        // Every variable is assigned, 0 is no variable
+        return 0;
+    }
+
+    void makeDecision() {
+
+        LID id = lookaheadMode ? laDecision.getId() : nextDecision();
+
+        // The heap ran out of unassigned variables
+        if (id == 0 && not lookaheadMode) {
+
+            finish();
+            return;
+        }
+
+        LST st = lookaheadMode ? laDecision.state() : (LST)phases.pick(id);
+
+        if (model[id] != UNDEF) {
+
+            std::cout << "Error in decision, variable " << id << " is assigned" << std::endl;
+            std::exit(1);
+        }
+
+        ++decisions;
+
+        modelStack.emplace_back(0, UNDEF);
+        ++nextIndex;
+        ++level;
+
+        setLit(id, st);
+    }
+
+    // Unassign everything above position pos of modelStack, which has no
+    // decision marker: lookaheads assign on top of the node without a level
+    void undoTo(size_t pos) {
+
+        while (modelStack.size() > pos) {
+
+            model[modelStack.back().getId()] = UNDEF;
+            modelStack.pop_back();
+        }
+
+        nextIndex = pos;
+    }
+
+    // Assign l on top of the propagated node and propagate, false on a conflict
+    inline bool tryLit(Lit l) {
+
+        setLit(l);
+
+        return not propagateGivesConflict();
+    }
+
+    // Weight of the clauses reduced but not satisfied by the assignments from
+    // pos on: a new binary clause counts 1, longer ones less and less
+    double reduction(size_t pos) {
+
+        double d = 0;
+
+        for (size_t i = pos; i < modelStack.size(); ++i) {
+
+            Lit f = modelStack[i];
+            f.reverse();
+
+            for (const TernaryWatch& w: ternWatches[f.index()])
+                d += (litValue(w.a) == 0) & (litValue(w.b) == 0);
+
+            for (CRef cr: longOccurs[f.index()]) {
+
+                int free = 0;
+                bool sat = false;
+
+                for (Lit l: clauseAt(cr)) {
+
+                    int v = litValue(l);
+
+                    sat |= v > 0;
+                    free += v == 0;
+                }
+
+                if (not sat && free >= 2)
+                    d += laShrunk[free];
+            }
+        }
+
+        return d;
+    }
+
+    // Candidates of the node: the free variables whose both literals occur most
+    // in the unsatisfied clauses, the top tenth but at least ten of them
+    void preselect() {
+
+        std::fill(laWeight.begin(), laWeight.end(), 0);
+
+        for (CRef cr: clauses) {
+
+            Clause c = clauseAt(cr);
+
+            int free = 0;
+            bool sat = false;
+
+            for (Lit l: c) {
+
+                int v = litValue(l);
+
+                sat |= v > 0;
+                free += v == 0;
+            }
+
+            if (sat || free < 2)
+                continue;
+
+            // Binary clauses count five times a ternary one, as they propagate
+            double w = 5 * laShrunk[free];
+
+            for (Lit l: c)
+                if (litValue(l) == 0)
+                    laWeight[l.index()] += w;
+        }
+
+        candidates.clear();
+
+        for (LID id = 1; id <= numVars; ++id) {
+
+            double pos = laWeight[Lit(id, TRUE).index()];
+            double neg = laWeight[Lit(id, FALSE).index()];
+
+            if (model[id] != UNDEF || pos + neg == 0)
+                continue;
+
+            laRank[id] = pos * neg + pos + neg;
+            candidates.push_back(id);
+        }
+
+        size_t keep = std::min(candidates.size(), std::max((size_t)10, candidates.size() / 10));
+
+        std::nth_element(candidates.begin(), candidates.begin() + (long)keep, candidates.end(), [this](LID a, LID b) {
+            return laRank[a] > laRank[b] || (laRank[a] == laRank[b] && a < b);
+        });
+
+        candidates.resize(keep);
+    }
+
+    // Second level under the current lookahead: a candidate that fails gets the
+    // other value, kept until the lookahead is undone. False if the lookahead
+    // literal turns out to fail, found sets if any candidate failed
+    bool doubleLook(bool& found) {
+
+        size_t pos = modelStack.size();
+
+        for (LID y: candidates)
+            for (LST st: {TRUE, FALSE}) {
+
+                if (model[y] != UNDEF)
+                    break;
+
+                Lit m = Lit(y, st);
+
+                bool ok = tryLit(m);
+
+                undoTo(pos);
+
+                if (ok)
+                    continue;
+
+                found = true;
+
+                m.reverse();
+
+                if (not tryLit(m))
+                    return false;
+
+                pos = modelStack.size();
+            }
+
+        return true;
+    }
+
+    // Lookahead on the candidates of the propagated node. A literal whose
+    // propagation fails, directly or through a double lookahead, gets the other
+    // value at the node. If that fails too, it is left unpropagated and false
+    // is returned: the caller finds the conflict. Otherwise the decision goes to
+    // laDecision, on the variable whose both literals reduce the formula most,
+    // the literal reducing it least first
+    bool lookahead() {
+
+        laDecision = Lit(0, UNDEF);
+        laLooked.clear();
+
+        preselect();
+
+        if (candidates.empty()) {
+
+            finishFree();
+            return true;
+        }
+
+        size_t pos = modelStack.size();
+
+        dlTrigger *= 0.95;
+
+        double bestRank = -1;
+
+        for (LID x: candidates) {
+
+            if (model[x] != UNDEF)
+                continue;
+
+            double d[2];
+
+            for (int s = 0; s < 2; ++s) {
+
+                Lit l = Lit(x, s == 0 ? TRUE : FALSE);
+
+                bool ok = tryLit(l);
+
+                if (ok) {
+
+                    d[s] = reduction(pos);
+
+                    if (d[s] > dlTrigger) {
+
+                        bool found = false;
+
+                        ok = doubleLook(found);
+
+                        if (ok && not found)
+                            dlTrigger = d[s];
+                    }
+                }
+
+                undoTo(pos);
+
+                if (ok)
+                    continue;
+
+                l.reverse();
+
+                if (not tryLit(l)) {
+
+                    undoTo(pos);
+                    setLit(l);
+
+                    return false;
+                }
+
+                pos = modelStack.size();
+                break;
+            }
+
+            // Assigned by a failed literal, now or earlier at this node
+            if (model[x] != UNDEF)
+                continue;
+
+            double rank = 1024 * d[0] * d[1] + d[0] + d[1];
+
+            laRank[x] = rank;
+            laLooked.emplace_back(x, d[0] <= d[1] ? TRUE : FALSE);
+
+            if (rank > bestRank) {
+
+                bestRank = rank;
+                laDecision = laLooked.back();
+            }
+        }
+
+        if (laDecision.getId() != 0 && model[laDecision.getId()] == UNDEF)
+            return true;
+
+        // A failed literal found after the best candidate assigned it: the
+        // best one still free instead
+        laDecision = Lit(0, UNDEF);
+        bestRank = -1;
+
+        for (Lit l: laLooked)
+            if (model[l.getId()] == UNDEF && laRank[l.getId()] > bestRank) {
+
+                bestRank = laRank[l.getId()];
+                laDecision = l;
+            }
+
+        if (laDecision.getId() != 0)
+            return true;
+
+        // Every candidate got assigned: the top of a new preselection, the
+        // literal occurring most first
+        preselect();
+
+        if (candidates.empty()) {
+
+            finishFree();
+            return true;
+        }
+
+        LID x = *std::max_element(candidates.begin(), candidates.end(), [this](LID a, LID b) {
+            return laRank[a] < laRank[b] || (laRank[a] == laRank[b] && a > b);
+        });
+
+        laDecision = Lit(x, laWeight[Lit(x, FALSE).index()] <= laWeight[Lit(x, TRUE).index()] ? TRUE : FALSE);
+
+        return true;
+    }
+
+    void initClauseIndex() {
+
+        binWatches.resize(2 * ((uint64_t)numVars + 1), std::vector<Lit>());
+        ternWatches.resize(2 * ((uint64_t)numVars + 1), std::vector<TernaryWatch>());
+        watches.resize(2 * ((uint64_t)numVars + 1), std::vector<CRef>());
+
+        if (lookaheadMode)
+            longOccurs.resize(2 * ((uint64_t)numVars + 1), std::vector<CRef>());
+
+        // Unit clauses are handled by unitClauses(), long ones watch their first two literals
+        for (CRef cr: clauses) {
+
+            Clause c = clauseAt(cr);
+
+            switch (c.size()) {
+
+                case 0:
+                    status = UNSATISFIABLE;
+                    return;
+                case 1:
+                    break;
+                case 2:
+                    binWatches[c[0].index()].push_back(c[1]);
+                    binWatches[c[1].index()].push_back(c[0]);
+                    break;
+                case 3:
+                    ternWatches[c[0].index()].push_back({c[1], c[2]});
+                    ternWatches[c[1].index()].push_back({c[0], c[2]});
+                    ternWatches[c[2].index()].push_back({c[0], c[1]});
+                    break;
+                default:
+                    watches[c[0].index()].push_back(cr);
+                    watches[c[1].index()].push_back(cr);
+
+                    if (lookaheadMode)
+                        for (Lit l: c)
+                            longOccurs[l.index()].push_back(cr);
+            }
+        }
+    }
+
+    void compPriority() {
+
+        std::fill(value.begin(), value.end(), 1);
+
+        value[0] = -1;
+
+        auto i = (double)numClauses;
+
+        for (CRef cr: clauses) {
+
+            Clause c = clauseAt(cr);
+
+            for (const Lit &l: c)
+                value[l.getId()] += log2(i);
+
+            for (const Lit& l: c)
+                value[l.getId()] *= 10;
+
+            --i;
+        }
+    }
+
+    void initScores() {
+
+        occurs.resize(numVars + 1, std::vector<uint32_t>());
+        assignedLits.resize(clauses.size(), 0);
+
+        size_t longest = 0;
+
+        for (uint32_t i = 0; i < clauses.size(); ++i) {
+
+            Clause c = clauseAt(clauses[i]);
+
+            for (Lit l: c)
+                occurs[l.getId()].push_back(i);
+
+            longest = std::max(longest, (size_t)c.size());
+        }
+
+        boostLog.resize(longest + 1);
+
+        for (size_t a = 0; a <= longest; ++a)
+            boostLog[a] = log(1 + 10 * (double)a);
+
+        // No literal is assigned yet, every clause contributes log(1)
+        score.resize(numVars + 1);
+        heapPos.resize(numVars + 1, -1);
+        isDirty.resize(numVars + 1, 0);
+        fixMark.resize(numVars + 1, 0);
+
+        for (LID id = 1; id <= numVars; ++id) {
+
+            score[id] = log(value[id]);
+
+            // Eliminated variables are not in the formula any more
+            if (not pre.isEliminated(id))
+                heapInsert(id);
+        }
+    }
+
+    void unitClauses() {
+
+        // Take care of initial unit clauses, if any
+        for (CRef cr: clauses) {
+
+            Clause c = clauseAt(cr);
+
+            if (c.size() != 1)
+                continue;
+
+            switch (currentModelValue(c[0])) {
+
+                case FALSE:
+                    status = UNSATISFIABLE;
+                    return;
+                case UNDEF:
+                    setLit(c[0]);
+                    break;
+                case TRUE:
+                    break;
+            }
+        }
+    }
+
+    void readInput(const std::string& path) {
+
+        DimacsReader reader = DimacsReader(path);
+
+        DimacsReader::Result res = reader.read<Lit>(
+                [] (int lit) { return lit > 0 ? Lit(lit, TRUE) : Lit(-lit, FALSE); },
+                [this] (const std::vector<Lit>& lits) {
+
+                    // The local search mode would walk forever
+                    if (lits.empty())
+                        status = UNSATISFIABLE;
+
+                    clauses.push_back(arena.alloc(lits.begin(), lits.end(), false));
+                });
+
+        numVars    = res.vars();
+        numClauses = clauses.size();
+    }
+
+    void preprocess(const Preprocessor::Passes& passes) {
+
+        pre = Preprocessor(numVars);
+
+        std::vector<int> c;
+
+        for (CRef cr: clauses) {
+
+            c.clear();
+
+            for (Lit l: clauseAt(cr))
+                c.push_back(l.state() == TRUE ? (int)l.getId() : -(int)l.getId());
+
+            pre.addClause(c);
+        }
+
+        arena.moveTo(input);
+        original.swap(clauses);
+
+        if (not pre.run(passes)) {
+
+            status = UNSATISFIABLE;
+            return;
+        }
+
+        std::vector<Lit> lits;
+
+        pre.forEachClause([this, &lits](const std::vector<int>& rc) {
+
+            lits.clear();
+
+            for (int l: rc)
+                lits.push_back(l > 0 ? Lit(l, TRUE) : Lit(-l, FALSE));
+
+            clauses.push_back(arena.alloc(lits.begin(), lits.end(), false));
+        });
+
+        pre.release();
+
+        numClauses = clauses.size();
+    }
+
+    static char stateToSymbol(LST st) {
+
+        switch (st) {
+            case FALSE:
+                return '-';
+            case TRUE:
+                return '+';
+            case UNDEF:
+                return ' ';
+            default:
+                return '?';
+        }
+    }
+
+    static void printErrorTerm(const Clause& c) {
+
+        std::cout << "Error in model, clause is not satisfied:";
+
+        for (Lit l: c)
+            std::cout << "[" << stateToSymbol(l.state()) << "]" << l.getId() << " ";
+
+        std::cout << std::endl;
+        std::exit(1);
+    }
+
+    bool someLitTrue(const Clause& c) {
+
+        return std::any_of(c.begin(), c.end(), [this](Lit l) -> bool {
+            return currentModelValue(l) == TRUE;
+        });
+    }
+
+    void checkModel() {
+
+        // The clauses as read, the preprocessor may have replaced some of them
+        ClauseArena<Lit>& from = pre.hasRun() ? input : arena;
+
+        for (CRef cr: pre.hasRun() ? original : clauses) {
+
+            Clause c = {from.begin(cr), from.size(cr)};
+
+            if (not someLitTrue(c))
+                printErrorTerm(c);
+        }
+    }
+
+    // Every variable has a value: extend the model to the original formula and check it
+    void finish() {
+
+        pre.extend([this](int var) { return (int8_t)model[var]; },
+                   [this](int var, int8_t v) { model[var] = (LST)v; });
+
+        checkModel();
+
+        status = SATISFIABLE;
+    }
+
+    // Every clause is satisfied, the free variables can take any value
+    void finishFree() {
+
+        for (LID id = 1; id <= numVars; ++id)
+            if (model[id] == UNDEF)
+                model[id] = (LST)phases.pick(id);
+
+        finish();
+    }
+
+    // effort: flips of the first walk per clause, each walk gets half more than the last
+    void initWalker(uint64_t effort, uint32_t seed) {
+
+        walker = LocalSearch((int)numVars, seed);
+
+        std::vector<int> c;
+
+        for (CRef cr: clauses) {
+
+            c.clear();
+
+            for (Lit l: clauseAt(cr))
+                c.push_back(l.state() == TRUE ? (int)l.getId() : -(int)l.getId());
+
+            walker.addClause(c);
+        }
+
+        walkFlips = effort * std::max<uint64_t>(clauses.size(), 1);
+    }
+
+    // Local search from the saved phases, which take its best assignment
+    void walk() {
+
+        walker.load([this](int var) { return phases.pick(var); });
+
+        if (walker.walk(walkFlips)) {
+
+            for (LID id = 1; id <= numVars; ++id)
+                model[id] = (LST)walker.value((int)id);
+
+            finish();
+            return;
+        }
+
+        walkFlips += walkFlips / 2;
+
+        phases.load(walker.getBest().begin(), walker.getBest().end());
+    }
+
+    LST currentModelValue(Lit l) {
+
+        if (model[l.getId()] == UNDEF)
+            return UNDEF;
+
+        if (model[l.getId()] == l.state())
+            return TRUE;
+
+        return FALSE;
+    }
+
+    void backtrack() {
+
+        Lit l = Lit(0, UNDEF);
+
+        phases.record(modelStack.size() - level, [this] (auto visit) {
+
+            for (const Lit& m: modelStack)
+                if (m.getId() != 0)
+                    visit(m.getId(), m.state());
+        });
+
+        for (auto it = modelStack.rbegin();
+             it != modelStack.rend();
+             ++it, modelStack.pop_back()
+                ) {
+
+            if (it->getId() == 0)
+                break;
+
+            l = *it;
+            phases.save(l.getId(), l.state());
+            model[l.getId()] = UNDEF;
+
+            if (lookaheadMode)
+                continue;
+
+            updateScores(l.getId(), -1);
+            rescore(l.getId());
+
+            if (heapPos[l.getId()] >= 0)
+                markDirty(l.getId());
+            else
+                heapInsert(l.getId());
+        }
+
+        modelStack.pop_back();
+        --level;
+        nextIndex = modelStack.size();
+
+        l.reverse();
+        setLit(l);
+
+        ++back;
+    }
+
+    void setLit(Lit l) {
+
+        modelStack.push_back(l);
+
+        model[l.getId()] = l.state();
+
+        if (not lookaheadMode)
+            updateScores(l.getId(), 1);
+    }
+
+    void setLit(LID id, LST st) {
+
+        modelStack.emplace_back(id, st);
+
+        model[id] = st;
+
+        if (not lookaheadMode)
+            updateScores(id, 1);
+    }
+
+    // Empty every list, keeping its memory for the next formula
+    template <class T>
+    static void recycle(std::vector<std::vector<T>>& lists) {
+
+        for (std::vector<T>& list: lists)
+            list.clear();
+    }
+
+public:
+
+    explicit Dpll(const DpllConfig& config = DpllConfig()) : config(config) {
+
+        reset();
+    }
+
+    Dpll(const Dpll&) = delete;
+    Dpll& operator = (const Dpll&) = delete;
+
+    // Forget the formula. Clause memory, watch and occurrence lists keep
+    // what they allocated, so the next load() mostly refills them.
+    void reset() {
+
+        numClauses = 0;
+        numVars    = 0;
+
+        arena.clear();
+        clauses.clear();
+        model.clear();
+        modelStack.clear();
+
+        input.clear();
+        original.clear();
+
+        pre = Preprocessor();
+
+        recycle(binWatches);
+        recycle(ternWatches);
+        recycle(watches);
+
+        value.clear();
+
+        recycle(occurs);
+        assignedLits.clear();
+        boostLog.clear();
+        score.clear();
+
+        heap.clear();
+        heapPos.clear();
+        dirty.clear();
+        isDirty.clear();
+        fixPos.clear();
+        fixMark.clear();
+
+        phases = Phases(0, FALSE);
+
+        walker    = LocalSearch();
+        walkFlips = 0;
+
+        lookaheadMode = config.mode == DpllConfig::LOOKAHEAD;
+        laDecision    = Lit(0, UNDEF);
+
+        candidates.clear();
+        laWeight.clear();
+        laRank.clear();
+        laLooked.clear();
+        recycle(longOccurs);
+        laShrunk.clear();
+
+        dlTrigger = 0;
+        nextIndex = 0;
+        level     = 0;
+        back      = 0;
+        status    = UNKNOWN;
+
+        decisions    = 0;
+        propagations = 0;
+    }
+
+    // Read a DIMACS file (stdin if path is empty), preprocess it and set up
+    // the search, in place of the formula loaded before if any. Throws
+    // DimacsReader::Error on bad input, the next load() starts over.
+    void load(const std::string& path) {
+
+        reset();
+
+        readInput(path);
+
+        if (config.preprocess.any())
+            preprocess(config.preprocess);
+
+        if (status != UNKNOWN)
+            return;
+
+        model.resize(numVars + 1, UNDEF);
+
+        phases = Phases(numVars + 1, FALSE, config.phases);
+
+        bool sls = config.mode == DpllConfig::SLS;
+
+        if (sls || config.phases.walks())
+            initWalker(config.walkEffort, config.phases.seed);
+
+        if (sls)
+            return;
+
+        value.resize(numVars + 1);
+
+        initClauseIndex();
+
+        if (status != UNKNOWN)
+            return;
+
+        if (lookaheadMode) {
+
+            laWeight.resize(2 * ((uint64_t)numVars + 1), 0);
+            laRank.resize(numVars + 1, 0);
+
+            size_t longest = 2;
+
+            for (CRef cr: clauses)
+                longest = std::max(longest, (size_t)arena.size(cr));
+
+            laShrunk.resize(longest + 1, 1);
+
+            for (size_t k = 3; k <= longest; ++k)
+                laShrunk[k] = laShrunk[k - 1] * 0.2;
+        }
+        else {
+
+            compPriority();
+
+            initScores();
+        }
+
+        unitClauses();
+    }
+
+    // SATISFIABLE with a checked model, UNSATISFIABLE, or UNKNOWN when the
+    // local search mode runs out of flips or terminate gives up
+    Result solve() {
+
+        if (status != UNKNOWN)
+            return status;
+
+        if (config.mode == DpllConfig::SLS) {
+
+            const uint64_t round = 1 << 20;
+
+            walker.load([](int) { return (int8_t)0; });
+
+            // Rounds of flips, to notice terminate between them
+            for (uint64_t done = 0; config.slsFlips == 0 || done < config.slsFlips; done += round) {
+
+                if (terminate && terminate())
+                    return UNKNOWN;
+
+                if (walker.walk(config.slsFlips == 0 ? round : std::min(round, config.slsFlips - done))) {
+
+                    for (LID id = 1; id <= numVars; ++id)
+                        model[id] = (LST)walker.value((int)id);
+
+                    finish();
+
+                    return status;
+                }
+            }
+
+            return UNKNOWN;
+        }
+
+        while (status == UNKNOWN) {
+
+            if (propagateGivesConflict()) {
+
+                if (level == 0) {
+
+                    status = UNSATISFIABLE;
+                    break;
+                }
+
+                backtrack();
+
+                if (phases.due(back) && phases.rephase() == Phases::WALK)
+                    walk();
+
+                continue;
+            }
+
+            // Failed literals were assigned, they need propagating first
+            if (lookaheadMode && not lookahead())
+                continue;
+
+            // Every clause satisfied at the lookahead
+            if (status != UNKNOWN)
+                break;
+
+            if (terminate && terminate())
+                return UNKNOWN;
+
+            makeDecision();
+        }
+
+        return status;
+    }
+
+    // Give up with UNKNOWN once f() is true, asked between decisions. Kept
+    // by reset(), a later solve() goes on with the search
+    void terminateWhen(std::function<bool()> f) {
+
+        terminate = std::move(f);
+    }
+
+    // Value of variable id (from 1) in the model, after SATISFIABLE
+    [[nodiscard]] inline LST getValue(LID id) const {
+
+        return model[id];
+    }
+
+    [[nodiscard]] inline LID vars() const {
+
+        return numVars;
+    }
+
+    [[nodiscard]] inline uint64_t getBacktracks() const {
+
+        return back;
+    }
+
+    [[nodiscard]] inline uint64_t getDecisions() const {
+
+        return decisions;
+    }
+
+    [[nodiscard]] inline uint64_t getPropagations() const {
+
+        return propagations;
+    }
+
+    [[nodiscard]] inline const Preprocessor& preprocessor() const {
+
+        return pre;
+    }
+};
+
+#define LI_SAT_SOLVER_DPLL_H
+
+#endif //LI_SAT_SOLVER_DPLL_H
@@ -0,0 +1,400 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#include "../common/Batch.h"
+#include "../common/Options.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Benchmark harness: runs engines over a corpus and scores them.
+//
+// Every instance runs in its own child process, one engine after the other
+// and never two at a time, so that timings do not disturb each other and
+// peak memory is per run. The engines are the solver executables of the
+// build, asked for their search counters with --stats. A run past the
+// timeout is killed and counts twice the timeout in the PAR-2 score.
+
+struct Engine {
+
+    std::string              name;
+    std::string              binary;
+    std::vector<std::string> args;
+};
+
+static const std::vector<Engine> ENGINES = {
+        {"dpll",      "LI_SAT_solver",      {}},
+        {"lookahead", "LI_SAT_solver",      {"--mode=lookahead"}},
+        {"cdcl",      "LI_SAT_solver_cdcl", {}}
+};
+
+// One engine on one instance
+struct Run {
+
+    std::string engine;
+    std::string instance;
+
+    // SATISFIABLE, UNSATISFIABLE, UNKNOWN, TIMEOUT or ERROR
+    std::string result;
+
+    double   seconds      = 0;
+    uint64_t conflicts    = 0;
+    uint64_t decisions    = 0;
+    uint64_t propagations = 0;
+
+    // Peak resident set of the child, in KiB
+    long rss = 0;
+
+    [[nodiscard]] inline bool solved() const {
+
+        return result == "SATISFIABLE" || result == "UNSATISFIABLE";
+    }
+
+    [[nodiscard]] inline double propsPerSec() const {
+
+        return seconds > 0 ? (double)propagations / seconds : 0;
+    }
+};
+
+// Read a "c <name> <count>" line of --stats into run, if it is one
+static void parseStat(const std::string& line, Run& run) {
+
+    std::istringstream in(line);
+
+    std::string c;
+    std::string name;
+    uint64_t    count;
+
+    if (not (in >> c >> name >> count) || c != "c")
+        return;
+
+    if (name == "conflicts")
+        run.conflicts = count;
+    else if (name == "decisions")
+        run.decisions = count;
+    else if (name == "propagations")
+        run.propagations = count;
+}
+
+static Run runOne(const Engine& engine, const std::string& binDir, const std::vector<std::string>& extra,
+                  const std::string& path, double timeout) {
+
+    Run run;
+
+    run.engine   = engine.name;
+    run.instance = path;
+
+    std::vector<std::string> args = {binDir + "/" + engine.binary};
+
+    args.insert(args.end(), engine.args.begin(), engine.args.end());
+    args.insert(args.end(), extra.begin(), extra.end());
+    args.emplace_back("--stats");
+    args.push_back(path);
+
+    std::vector<char*> argv;
+
+    for (std::string& a: args)
+        argv.push_back(a.data());
+
+    argv.push_back(nullptr);
+
+    int out[2];
+
+    if (pipe(out) != 0) {
+
+        run.result = "ERROR";
+        return run;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    pid_t pid = fork();
+
+    if (pid == 0) {
+
+        dup2(out[1], STDOUT_FILENO);
+        close(out[0]);
+        close(out[1]);
+
+        execv(argv[0], argv.data());
+        _exit(127);
+    }
+
+    close(out[1]);
+
+    std::string text;
+    bool        killed = false;
+
+    auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(timeout));
+
+    // Collect the output until the child closes it, or kill it at the timeout
+    while (pid > 0) {
+
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(end - std::chrono::steady_clock::now());
+
+        if (left.count() <= 0) {
+
+            kill(pid, SIGKILL);
+            killed = true;
+            break;
+        }
+
+        pollfd p = {out[0], POLLIN, 0};
+
+        int ready = poll(&p, 1, (int)std::min<long long>(left.count(), 1000));
+
+        if (ready < 0 && errno != EINTR)
+            break;
+
+        if (ready <= 0)
+            continue;
+
+        char    buf[4096];
+        ssize_t n = read(out[0], buf, sizeof(buf));
+
+        if (n <= 0)
+            break;
+
+        text.append(buf, (size_t)n);
+    }
+
+    close(out[0]);
+
+    int    status = 0;
+    rusage usage{};
+
+    if (pid < 0 || wait4(pid, &status, 0, &usage) < 0) {
+
+        run.result = "ERROR";
+        return run;
+    }
+
+    run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    run.rss     = usage.ru_maxrss;
+
+    std::istringstream lines(text);
+    std::string        line;
+
+    while (std::getline(lines, line))
+        parseStat(line, run);
+
+    if (killed) {
+
+        run.result  = "TIMEOUT";
+        run.seconds = std::min(run.seconds, timeout);
+    }
+    else if (WIFEXITED(status) && WEXITSTATUS(status) == 20)
+        run.result = "SATISFIABLE";
+    else if (WIFEXITED(status) && WEXITSTATUS(status) == 10)
+        run.result = "UNSATISFIABLE";
+    else if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        run.result = "UNKNOWN";
+    else
+        run.result = "ERROR";
+
+    return run;
+}
+
+static std::string jsonString(const std::string& s) {
+
+    std::string out = "\"";
+
+    for (char ch: s) {
+
+        if (ch == '"' || ch == '\\')
+            out += '\\';
+
+        out += ch;
+    }
+
+    return out + '"';
+}
+
+static void writeCsv(const std::string& path, const std::vector<Run>& runs) {
+
+    std::ofstream os(path);
+
+    os << "engine,instance,result,seconds,conflicts,decisions,propagations,props_per_sec,peak_rss_kib\n";
+
+    for (const Run& r: runs)
+        os << r.engine << ',' << r.instance << ',' << r.result << ',' << r.seconds << ',' << r.conflicts << ','
+           << r.decisions << ',' << r.propagations << ',' << r.propsPerSec() << ',' << r.rss << '\n';
+}
+
+// Per engine: totals, then every run
+static void writeJson(const std::string& path, const std::vector<std::string>& engines,
+                      const std::vector<Run>& runs, double timeout) {
+
+    std::ofstream os(path);
+
+    os << "{\n  \"timeout\": " << timeout << ",\n  \"engines\": [";
+
+    for (size_t e = 0; e < engines.size(); ++e) {
+
+        size_t sat   = 0;
+        size_t unsat = 0;
+        double par2  = 0;
+
+        for (const Run& r: runs)
+            if (r.engine == engines[e]) {
+
+                sat   += r.result == "SATISFIABLE";
+                unsat += r.result == "UNSATISFIABLE";
+                par2  += r.solved() ? r.seconds : 2 * timeout;
+            }
+
+        os << (e == 0 ? "" : ",") << "\n    {\"name\": " << jsonString(engines[e]) << ", \"solved\": "
+           << sat + unsat << ", \"sat\": " << sat << ", \"unsat\": " << unsat << ", \"par2\": " << par2
+           << ", \"runs\": [";
+
+        bool first = true;
+
+        for (const Run& r: runs) {
+
+            if (r.engine != engines[e])
+                continue;
+
+            os << (first ? "" : ",") << "\n      {\"instance\": " << jsonString(r.instance) << ", \"result\": "
+               << jsonString(r.result) << ", \"seconds\": " << r.seconds << ", \"conflicts\": " << r.conflicts
+               << ", \"decisions\": " << r.decisions << ", \"propagations\": " << r.propagations
+               << ", \"props_per_sec\": " << r.propsPerSec() << ", \"peak_rss_kib\": " << r.rss << "}";
+
+            first = false;
+        }
+
+        os << "\n    ]}";
+    }
+
+    os << "\n  ]\n}\n";
+}
+
+// LI_SAT_bench [--engines=dpll,lookahead,cdcl] [--timeout=<s>] [--bin-dir=<dir>]
+//              [--args="<solver options>"] [--csv=<file>] [--json=<file>] <files, directories, @lists>
+int main(int argc, char** argv) {
+
+    Options opts = Options(argc, argv);
+
+    std::vector<std::string> instances;
+    std::string              error;
+
+    if (not Batch::expand(opts.getPositional(), instances, error)) {
+
+        std::cerr << "c " << error << std::endl;
+        return 1;
+    }
+
+    if (instances.empty()) {
+
+        std::cerr << "c no instances given" << std::endl;
+        return 1;
+    }
+
+    double timeout = opts.getDouble("timeout", 60);
+
+    if (timeout <= 0)
+        Options::fail("timeout", opts.get("timeout", ""));
+
+    // The solvers of the same build by default
+    std::string binDir = std::filesystem::path(argv[0]).parent_path().string();
+
+    binDir = opts.get("bin-dir", binDir.empty() ? "." : binDir);
+
+    std::vector<std::string> extra;
+    std::istringstream       words(opts.get("args", ""));
+
+    for (std::string w; words >> w;)
+        extra.push_back(w);
+
+    std::string csv  = opts.get("csv", "");
+    std::string json = opts.get("json", "");
+
+    std::vector<const Engine*> engines;
+    std::vector<std::string>   names;
+    std::istringstream         list(opts.get("engines", "dpll,cdcl"));
+
+    for (std::string name; std::getline(list, name, ',');) {
+
+        auto it = std::find_if(ENGINES.begin(), ENGINES.end(), [&name] (const Engine& e) { return e.name == name; });
+
+        if (it == ENGINES.end())
+            Options::fail("engines", name);
+
+        engines.push_back(&*it);
+        names.push_back(name);
+    }
+
+    opts.rejectUnknown();
+
+    std::vector<Run> runs;
+
+    size_t mismatches = 0;
+
+    for (const std::string& path: instances) {
+
+        std::string answer;
+
+        for (const Engine* e: engines) {
+
+            runs.push_back(runOne(*e, binDir, extra, path, timeout));
+
+            const Run& r = runs.back();
+
+            std::cout << r.engine << ' ' << r.instance << ' ' << r.result << ' ' << r.seconds << " s "
+                      << r.conflicts << " conflicts " << r.decisions << " decisions " << r.propsPerSec()
+                      << " props/s " << r.rss << " KiB" << std::endl;
+
+            if (not r.solved())
+                continue;
+
+            if (not answer.empty() && answer != r.result) {
+
+                std::cout << "c mismatch on " << path << std::endl;
+                ++mismatches;
+            }
+
+            answer = r.result;
+        }
+    }
+
+    for (const std::string& name: names) {
+
+        size_t sat   = 0;
+        size_t unsat = 0;
+        size_t total = 0;
+        double par2  = 0;
+
+        for (const Run& r: runs)
+            if (r.engine == name) {
+
+                ++total;
+                sat   += r.result == "SATISFIABLE";
+                unsat += r.result == "UNSATISFIABLE";
+                par2  += r.solved() ? r.seconds : 2 * timeout;
+            }
+
+        std::cout << "c " << name << ": " << sat + unsat << '/' << total << " solved (" << sat << " sat, " << unsat
+                  << " unsat), PAR-2 " << par2 << " s" << std::endl;
+    }
+
+    if (not csv.empty())
+        writeCsv(csv, runs);
+
+    if (not json.empty())
+        writeJson(json, names, runs, timeout);
+
+    return mismatches == 0 ? 0 : 2;
+}
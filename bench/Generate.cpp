@@ -0,0 +1,41 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#include "Generator.h"
+#include <fstream>
+#include <iostream>
+
+// CNF generator for scaling benchmarks, DIMACS to --out or stdout
+//
+// LI_SAT_gen [--family=random|pigeonhole|parity|colouring] [--vars=<n>] [--ratio=<clauses per variable>]
+//            [--k=<clause size>] [--holes=<n>] [--colours=<n>] [--degree=<average>] [--planted]
+//            [--seed=<n>] [--out=<file>]
+int main(int argc, char** argv) {
+
+    Options opts = Options(argc, argv);
+
+    Generator::Config config = Generator::fromOptions(opts);
+
+    std::string path = opts.get("out", "");
+
+    opts.rejectUnknown();
+
+    if (path.empty()) {
+
+        Generator(config, std::cout).write();
+        return 0;
+    }
+
+    std::ofstream out(path, std::ios::binary);
+
+    if (not out) {
+
+        std::cerr << "c cannot open " << path << std::endl;
+        return 1;
+    }
+
+    Generator(config, out).write();
+
+    return out ? 0 : 1;
+}
@@ -0,0 +1,436 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_GENERATOR_H
+
+#include "../common/Options.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <initializer_list>
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// DIMACS output in large blocks, literals formatted by hand: formulas of
+// tens of millions of clauses are written at disk speed.
+class DimacsWriter {
+
+private:
+
+    std::ostream& os;
+    std::string   buf;
+
+    inline void spill() {
+
+        if (buf.size() >= ((size_t)1 << 20))
+            flush();
+    }
+
+public:
+
+    explicit DimacsWriter(std::ostream& os) : os(os) {}
+
+    DimacsWriter(const DimacsWriter&) = delete;
+    DimacsWriter& operator = (const DimacsWriter&) = delete;
+
+    ~DimacsWriter() {
+
+        flush();
+    }
+
+    void comment(const std::string& text) {
+
+        buf += "c ";
+        buf += text;
+        buf += '\n';
+    }
+
+    void header(uint64_t vars, uint64_t clauses) {
+
+        buf += "p cnf " + std::to_string(vars) + ' ' + std::to_string(clauses) + '\n';
+    }
+
+    // DIMACS literal: variable from 1, negative when negated
+    inline void lit(uint64_t var, bool negated) {
+
+        char  digits[24];
+        char* p = digits + sizeof(digits);
+
+        do {
+
+            *--p = (char)('0' + var % 10);
+            var /= 10;
+        } while (var != 0);
+
+        if (negated)
+            buf += '-';
+
+        buf.append(p, digits + sizeof(digits) - p);
+        buf += ' ';
+    }
+
+    inline void end() {
+
+        buf += "0\n";
+        spill();
+    }
+
+    void flush() {
+
+        os.write(buf.data(), (std::streamsize)buf.size());
+        buf.clear();
+    }
+};
+
+// Scalable CNF families for scaling curves, sized by a number of variables
+// that the structured families round to their own shape:
+//
+//   random:     uniform k-SAT, ratio * vars clauses of k distinct variables
+//   pigeonhole: holes + 1 pigeons into holes, unsatisfiable, n^3 clauses
+//   parity:     two XOR chains over the same variables in different orders,
+//               Tseitin encoded with opposite parities: unsatisfiable
+//   colouring:  colours-colouring of a random graph of vars / colours nodes
+//               and average degree degree, one variable per node and colour
+//
+// planted hides a solution in random (each clause falsified by it gets a
+// literal flipped), parity (both chains get the same parity) and colouring
+// (edges only join nodes it colours differently): the formula is then
+// satisfiable. The same seed gives the same formula.
+class Generator {
+
+public:
+
+    enum Family {
+        RANDOM,
+        PIGEONHOLE,
+        PARITY,
+        COLOURING
+    };
+
+    // Runtime settings, see fromOptions()
+    struct Config {
+
+        Family   family  = RANDOM;
+        uint64_t vars    = 1000;
+        double   ratio   = 4.2;
+        uint32_t k       = 3;
+        uint32_t colours = 3;
+        double   degree  = 4.6;
+        bool     planted = false;
+        uint32_t seed    = 0;
+
+        // Pigeonhole: number of holes, 0 for the most within vars
+        uint64_t holes = 0;
+    };
+
+private:
+
+    Config config;
+
+    std::mt19937_64 rng;
+
+    DimacsWriter out;
+
+    [[nodiscard]] inline uint64_t below(uint64_t n) {
+
+        return rng() % n;
+    }
+
+    [[nodiscard]] inline bool coin() {
+
+        return rng() & 1;
+    }
+
+    void random() {
+
+        const uint64_t n       = config.vars;
+        const uint64_t clauses = (uint64_t)std::llround(config.ratio * (double)n);
+
+        std::vector<bool> solution;
+
+        if (config.planted)
+            for (uint64_t v = 0; v < n; ++v)
+                solution.push_back(coin());
+
+        out.comment("random " + std::to_string(config.k) + "-SAT, ratio " + std::to_string(config.ratio) +
+                    (config.planted ? ", planted" : "") + ", seed " + std::to_string(config.seed));
+        out.header(n, clauses);
+
+        std::vector<uint64_t> vars;
+        std::vector<bool>     negated;
+
+        for (uint64_t i = 0; i < clauses; ++i) {
+
+            vars.clear();
+            negated.clear();
+
+            while (vars.size() < config.k) {
+
+                uint64_t v = below(n);
+
+                if (std::find(vars.begin(), vars.end(), v) == vars.end()) {
+
+                    vars.push_back(v);
+                    negated.push_back(coin());
+                }
+            }
+
+            if (config.planted) {
+
+                bool satisfied = false;
+
+                for (size_t j = 0; j < vars.size(); ++j)
+                    satisfied = satisfied || solution[vars[j]] != negated[j];
+
+                if (not satisfied) {
+
+                    size_t j = below(vars.size());
+
+                    negated[j] = not negated[j];
+                }
+            }
+
+            for (size_t j = 0; j < vars.size(); ++j)
+                out.lit(vars[j] + 1, negated[j]);
+
+            out.end();
+        }
+    }
+
+    void pigeonhole() {
+
+        uint64_t n = config.holes;
+
+        if (n == 0)
+            for (n = 1; (n + 1) * (n + 2) <= config.vars; ++n);
+
+        // Variable of pigeon p in hole h
+        auto in = [n] (uint64_t p, uint64_t h) { return p * n + h + 1; };
+
+        out.comment("pigeonhole, " + std::to_string(n + 1) + " pigeons, " + std::to_string(n) + " holes");
+        out.header((n + 1) * n, (n + 1) + n * (n + 1) * n / 2);
+
+        // Every pigeon somewhere
+        for (uint64_t p = 0; p <= n; ++p) {
+
+            for (uint64_t h = 0; h < n; ++h)
+                out.lit(in(p, h), false);
+
+            out.end();
+        }
+
+        // No two pigeons in a hole
+        for (uint64_t h = 0; h < n; ++h)
+            for (uint64_t p = 0; p <= n; ++p)
+                for (uint64_t q = p + 1; q <= n; ++q) {
+
+                    out.lit(in(p, h), true);
+                    out.lit(in(q, h), true);
+                    out.end();
+                }
+    }
+
+    // Signed DIMACS literals
+    void ternary(int64_t a, int64_t b, int64_t c) {
+
+        for (int64_t l: {a, b, c})
+            out.lit((uint64_t)std::abs(l), l < 0);
+
+        out.end();
+    }
+
+    // t = a xor b
+    void defineXor(int64_t t, int64_t a, int64_t b) {
+
+        ternary(-t, a, b);
+        ternary(-t, -a, -b);
+        ternary(t, -a, b);
+        ternary(t, a, -b);
+    }
+
+    // x[order[0]] xor ... xor x[order.back()] = parity, the partial sums in
+    // the variables from first on
+    void chain(const std::vector<uint64_t>& order, uint64_t first, bool parity) {
+
+        uint64_t sum = order[0] + 1;
+
+        for (size_t i = 1; i < order.size(); ++i) {
+
+            defineXor((int64_t)first, (int64_t)sum, (int64_t)order[i] + 1);
+            sum = first++;
+        }
+
+        out.lit(sum, not parity);
+        out.end();
+    }
+
+    void parity() {
+
+        // n inputs and two chains of n - 1 partial sums
+        const uint64_t n = std::max<uint64_t>(2, (config.vars + 2) / 3);
+
+        std::vector<uint64_t> order;
+
+        for (uint64_t v = 0; v < n; ++v)
+            order.push_back(v);
+
+        bool first  = coin();
+        bool second = config.planted ? first : not first;
+
+        out.comment("parity chains, " + std::to_string(n) + " inputs" + (config.planted ? ", planted" : "") +
+                    ", seed " + std::to_string(config.seed));
+        out.header(3 * n - 2, 8 * (n - 1) + 2);
+
+        chain(order, n + 1, first);
+
+        std::shuffle(order.begin(), order.end(), rng);
+
+        chain(order, 2 * n, second);
+    }
+
+    void colouring() {
+
+        const uint64_t k     = std::max<uint32_t>(1, config.colours);
+        const uint64_t nodes = std::max<uint64_t>(1, config.vars / k);
+
+        std::vector<uint64_t> colour;
+
+        if (config.planted)
+            for (uint64_t v = 0; v < nodes; ++v)
+                colour.push_back(below(k));
+
+        uint64_t edges = (uint64_t)std::llround(config.degree * (double)nodes / 2);
+
+        // Edges need two nodes, and two colours in the planted colouring
+        if (nodes < 2 || (config.planted && std::count(colour.begin(), colour.end(), colour[0]) == (long)nodes))
+            edges = 0;
+
+        // Variable of node v in colour c
+        auto has = [k] (uint64_t v, uint64_t c) { return v * k + c + 1; };
+
+        out.comment(std::to_string(k) + "-colouring, " + std::to_string(nodes) + " nodes, " +
+                    std::to_string(edges) + " edges" + (config.planted ? ", planted" : "") + ", seed " +
+                    std::to_string(config.seed));
+        out.header(nodes * k, nodes * (1 + k * (k - 1) / 2) + edges * k);
+
+        for (uint64_t v = 0; v < nodes; ++v) {
+
+            // At least one colour, and at most one
+            for (uint64_t c = 0; c < k; ++c)
+                out.lit(has(v, c), false);
+
+            out.end();
+
+            for (uint64_t c = 0; c < k; ++c)
+                for (uint64_t d = c + 1; d < k; ++d) {
+
+                    out.lit(has(v, c), true);
+                    out.lit(has(v, d), true);
+                    out.end();
+                }
+        }
+
+        // Repeated edges only repeat clauses
+        for (uint64_t e = 0; e < edges; ++e) {
+
+            uint64_t u;
+            uint64_t v;
+
+            do {
+
+                u = below(nodes);
+                v = below(nodes);
+            } while (u == v || (config.planted && colour[u] == colour[v]));
+
+            for (uint64_t c = 0; c < k; ++c) {
+
+                out.lit(has(u, c), true);
+                out.lit(has(v, c), true);
+                out.end();
+            }
+        }
+    }
+
+public:
+
+    Generator(const Config& config, std::ostream& os) : config(config), rng(config.seed), out(os) {}
+
+    void write() {
+
+        switch (config.family) {
+
+            case RANDOM:
+                random();
+                break;
+            case PIGEONHOLE:
+                pigeonhole();
+                break;
+            case PARITY:
+                parity();
+                break;
+            case COLOURING:
+                colouring();
+        }
+
+        out.flush();
+    }
+
+    // --family=random|pigeonhole|parity|colouring  --vars=<n>  --ratio=<clauses per variable>  --k=<clause size>
+    // --holes=<n>  --colours=<n>  --degree=<average>  --planted  --seed=<n>
+    // defaults: the settings of the options not given
+    [[nodiscard]] static Config fromOptions(const Options& opts, const Config& defaults) {
+
+        Config config = defaults;
+
+        config.family = (Family)opts.choice("family", {"random", "pigeonhole", "parity", "colouring"}, config.family);
+
+        long long vars    = opts.getInt("vars", (long long)config.vars);
+        long long k       = opts.getInt("k", config.k);
+        long long holes   = opts.getInt("holes", (long long)config.holes);
+        long long colours = opts.getInt("colours", config.colours);
+
+        // Variables must fit the DIMACS reader
+        if (vars < 1 || vars > INT32_MAX)
+            Options::fail("vars", std::to_string(vars));
+
+        if (k < 1 || (config.family == RANDOM && k > vars))
+            Options::fail("k", std::to_string(k));
+
+        // Its variables too
+        if (holes < 0 || holes > 46340)
+            Options::fail("holes", std::to_string(holes));
+
+        if (colours < 1 || (config.family == COLOURING && colours > vars))
+            Options::fail("colours", std::to_string(colours));
+
+        config.vars    = (uint64_t)vars;
+        config.k       = (uint32_t)k;
+        config.holes   = (uint64_t)holes;
+        config.colours = (uint32_t)colours;
+        config.ratio   = opts.getDouble("ratio", config.ratio);
+        config.degree  = opts.getDouble("degree", config.degree);
+        config.planted = opts.getInt("planted", config.planted) != 0;
+        config.seed    = (uint32_t)opts.getInt("seed", config.seed);
+
+        if (config.ratio < 0)
+            Options::fail("ratio", opts.get("ratio", ""));
+
+        if (config.degree < 0)
+            Options::fail("degree", opts.get("degree", ""));
+
+        return config;
+    }
+
+    [[nodiscard]] static Config fromOptions(const Options& opts) {
+
+        return fromOptions(opts, Config());
+    }
+};
+
+#define LI_SAT_SOLVER_GENERATOR_H
+
+#endif //LI_SAT_SOLVER_GENERATOR_H
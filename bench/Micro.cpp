@@ -0,0 +1,88 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#include "Micro.h"
+#include "Generator.h"
+#include "../common/Dimacs.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include <unistd.h>
+
+// Both engines have their own types of literals and clauses, hence one
+// translation unit each
+void benchDpll(Micro& micro, const std::string& path, uint32_t seed);
+void benchCdcl(Micro& micro, const std::string& path, uint32_t seed);
+
+// Component microbenchmarks: parsing, index building, propagation, decision
+// and conflict analysis, each timed alone on a fixed input. The input is a
+// formula of Generator written to a temporary file, 100000 variables of
+// random 3-SAT by default, unless a DIMACS file is given.
+//
+// LI_SAT_micro [generator options, see Generator::fromOptions()] [--reps=<n>] [--min-ms=<ms>]
+//              [--kernels=<name,...>] [<file>]
+int main(int argc, char** argv) {
+
+    Options opts = Options(argc, argv);
+
+    Micro::Config config;
+
+    config.reps  = (size_t)std::max(1LL, opts.getInt("reps", 15));
+    config.minMs = std::max(0.0, opts.getDouble("min-ms", 20));
+    config.only  = opts.get("kernels", "");
+
+    Generator::Config defaults;
+
+    defaults.vars = 100000;
+
+    Generator::Config gen = Generator::fromOptions(opts, defaults);
+
+    opts.rejectUnknown();
+
+    std::string path;
+    bool        temporary = opts.getPositional().empty();
+
+    if (temporary) {
+
+        char name[] = "/tmp/LI_SAT_micro_XXXXXX";
+        int  fd     = mkstemp(name);
+
+        if (fd < 0) {
+
+            std::cerr << "c cannot create a temporary file" << std::endl;
+            return 1;
+        }
+
+        close(fd);
+
+        path = name;
+
+        std::ofstream out(path);
+
+        Generator(gen, out).write();
+    }
+    else
+        path = opts.getPositional()[0];
+
+    Micro micro = Micro(config, std::cout);
+
+    int status = 0;
+
+    try {
+
+        benchCdcl(micro, path, gen.seed);
+        benchDpll(micro, path, gen.seed);
+    }
+    catch (const DimacsReader::Error& e) {
+
+        std::cerr << "c " << e.what() << std::endl;
+        status = 1;
+    }
+
+    if (temporary)
+        std::remove(path.c_str());
+
+    return status;
+}
@@ -0,0 +1,148 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_MICRO_H
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Timing of one component at a time. A kernel is a setup, not timed, and a
+// body, timed, which returns the number of operations it did. A repetition
+// runs setup and body enough times to last minMs; the first repetitions
+// calibrate that count and warm the caches up, then reps more are kept.
+//
+// Reported per operation: the median over the repetitions, the fastest,
+// and the spread as the median absolute deviation over the median.
+class Micro {
+
+public:
+
+    struct Config {
+
+        size_t reps  = 15;
+        double minMs = 20;
+
+        // Comma separated kernel names to run, all if empty
+        std::string only;
+    };
+
+private:
+
+    Config config;
+
+    std::ostream& os;
+
+    // Whether a kernel to run is name, or starts with it if prefix
+    [[nodiscard]] bool selected(const std::string& name, bool prefix) const {
+
+        if (config.only.empty())
+            return true;
+
+        std::stringstream ss(config.only);
+        std::string       item;
+
+        while (std::getline(ss, item, ','))
+            if (prefix ? item.rfind(name, 0) == 0 : item == name)
+                return true;
+
+        return false;
+    }
+
+    // Nanoseconds and operations of iters setups and bodies, the bodies only timed
+    template <class Setup, class Body>
+    static std::pair<double, uint64_t> measure(size_t iters, Setup& setup, Body& body) {
+
+        double   ns  = 0;
+        uint64_t ops = 0;
+
+        for (size_t i = 0; i < iters; ++i) {
+
+            setup();
+
+            auto start = std::chrono::steady_clock::now();
+
+            ops += body();
+
+            ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        return {ns, ops};
+    }
+
+public:
+
+    Micro(const Config& config, std::ostream& os) : config(config), os(os) {}
+
+    // Whether a kernel whose name starts with prefix is to run, to skip
+    // loading an engine for nothing
+    [[nodiscard]] inline bool selects(const std::string& prefix) const {
+
+        return selected(prefix, true);
+    }
+
+    // unit: what an operation of body is, for the report
+    template <class Setup, class Body>
+    void run(const std::string& name, const std::string& unit, Setup setup, Body body) {
+
+        if (not selected(name, false))
+            return;
+
+        size_t iters = 1;
+
+        // Calibration, doubling the iterations until a repetition lasts long enough
+        while (iters < ((size_t)1 << 30)) {
+
+            if (measure(iters, setup, body).first >= config.minMs * 1e6)
+                break;
+
+            iters *= 2;
+        }
+
+        std::vector<double> perOp;
+        uint64_t            ops = 0;
+
+        for (size_t r = 0; r < config.reps; ++r) {
+
+            auto [ns, n] = measure(iters, setup, body);
+
+            ops = n;
+
+            if (n != 0)
+                perOp.push_back(ns / (double)n);
+        }
+
+        if (perOp.empty()) {
+
+            os << name << ": no " << unit << " to time" << std::endl;
+            return;
+        }
+
+        std::sort(perOp.begin(), perOp.end());
+
+        double median = perOp[perOp.size() / 2];
+
+        std::vector<double> dev;
+
+        for (double x: perOp)
+            dev.push_back(std::abs(x - median));
+
+        std::sort(dev.begin(), dev.end());
+
+        double mad = dev[dev.size() / 2];
+
+        os << name << ": " << median << " ns/" << unit << " (min " << perOp.front() << ", MAD "
+           << 100 * mad / median << "%, " << perOp.size() << " reps x " << iters << " runs, "
+           << ops / iters << ' ' << unit << "s per run)" << std::endl;
+    }
+};
+
+#define LI_SAT_SOLVER_MICRO_H
+
+#endif //LI_SAT_SOLVER_MICRO_H
@@ -0,0 +1,164 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#include "Micro.h"
+#include "../CDCL/Problem.h"
+#include <random>
+
+// Kernels of the CDCL engine, on a formula read without preprocessing
+struct ProblemMicro {
+
+    Problem& p;
+
+    // Decisions of the fixed trail: random ones, up to the first conflict,
+    // and the decision that gives it
+    std::vector<L> trail;
+    L              last = L(0, UNDEF);
+
+    explicit ProblemMicro(Problem& p) : p(p) {}
+
+    // Replay the trail from level 0, without its last decision
+    void replay() {
+
+        p.stack.backjump(0);
+
+        for (L l: trail) {
+
+            p.stack.setDecision(l.getId(), l.getSt());
+            p.findConflict();
+        }
+    }
+
+    void makeTrail(uint32_t seed) {
+
+        std::vector<LID> order;
+
+        for (LID id = 0; id < p.numVars; ++id)
+            order.push_back(id);
+
+        std::mt19937 rng(seed);
+
+        std::shuffle(order.begin(), order.end(), rng);
+
+        p.findConflict();
+
+        for (LID id: order) {
+
+            if ((*p.model)[id] != UNDEF)
+                continue;
+
+            L l = L(id, rng() & 1 ? TRUE : FALSE);
+
+            p.stack.setDecision(l.getId(), l.getSt());
+
+            if (p.findConflict()) {
+
+                last = l;
+                break;
+            }
+
+            trail.push_back(l);
+        }
+
+        p.stack.backjump(0);
+    }
+
+    void run(Micro& micro, const Formula& formula, const ProblemConfig& config, uint32_t seed) {
+
+        // Watch lists and the copy of the long clauses, over recycled memory
+        micro.run("cdcl.index", "clause", [] () {}, [this, &formula, &config] () {
+
+            p.reset(formula, config);
+            return (uint64_t)formula.getClauses().size();
+        });
+
+        makeTrail(seed);
+
+        micro.run("cdcl.propagate", "propagation", [this] () { p.stack.backjump(0); }, [this] () {
+
+            uint64_t before = p.propagations;
+
+            for (L l: trail) {
+
+                p.stack.setDecision(l.getId(), l.getSt());
+                p.findConflict();
+            }
+
+            return p.propagations - before;
+        });
+
+        // Every variable out of a freshly filled heap
+        micro.run("cdcl.decide", "decision", [this] () {
+
+            p.stack.backjump(0);
+
+            for (LID id = 0; id < p.numVars; ++id)
+                p.stack.getOrder().insert(id);
+        }, [this] () {
+
+            uint64_t n = 0;
+
+            while (p.nextDecision() != p.numVars)
+                ++n;
+
+            return n;
+        });
+
+        bool inConflict = false;
+
+        // First UIP learning from the conflict of the trail, backjump included
+        micro.run("cdcl.analyze", "conflict", [this, &inConflict] () {
+
+            replay();
+
+            if (last.getSt() != UNDEF) {
+
+                p.stack.setDecision(last.getId(), last.getSt());
+                inConflict = p.findConflict();
+            }
+        }, [this, &inConflict] () {
+
+            if (not inConflict)
+                return (uint64_t)0;
+
+            std::vector<L> learnt = p.stack.popConflict(p.ca, *p.tern, p.conflict, p.conflictLit, [] (CRef) {});
+
+            return (uint64_t)(not learnt.empty());
+        });
+
+        p.stack.backjump(0);
+    }
+};
+
+void benchCdcl(Micro& micro, const std::string& path, uint32_t seed) {
+
+    Preprocessor::Passes none = {false, false, false};
+
+    // The reader alone, into an arena as Formula does
+    ClauseArena<L> arena;
+
+    micro.run("parse", "clause", [&arena] () { arena.clear(); }, [&arena, &path] () {
+
+        DimacsReader reader = DimacsReader(path);
+
+        DimacsReader::Result res = reader.read<L>(
+                [] (int lit) { return lit > 0 ? L(lit - 1, TRUE) : L(-lit - 1, FALSE); },
+                [&arena] (const std::vector<L>& lits) { arena.alloc(lits.begin(), lits.end(), false); });
+
+        return res.clauses;
+    });
+
+    if (not micro.selects("cdcl."))
+        return;
+
+    Formula formula = Formula(path, none);
+
+    ProblemConfig config;
+
+    config.preprocess = none;
+
+    Problem p = Problem(formula, config);
+
+    ProblemMicro(p).run(micro, formula, config, seed);
+}
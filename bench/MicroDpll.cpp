@@ -0,0 +1,172 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#include "Micro.h"
+#include "../DPLL/Dpll.h"
+#include <random>
+
+// Kernels of the DPLL engine, on a formula loaded without preprocessing
+struct DpllMicro {
+
+    Dpll& d;
+
+    // Decisions of the fixed trail: random ones, up to the first conflict
+    std::vector<Lit> trail;
+
+    explicit DpllMicro(Dpll& d) : d(d) {}
+
+    void decide(Lit l) {
+
+        d.modelStack.emplace_back(0, UNDEF);
+        ++d.nextIndex;
+        ++d.level;
+
+        d.setLit(l);
+    }
+
+    // Back to no assignment, scores and heap as backtrack() leaves them
+    void undoAll() {
+
+        while (not d.modelStack.empty()) {
+
+            Lit l = d.modelStack.back();
+
+            d.modelStack.pop_back();
+
+            if (l.getId() == 0)
+                continue;
+
+            d.model[l.getId()] = UNDEF;
+
+            d.updateScores(l.getId(), -1);
+            d.rescore(l.getId());
+
+            if (d.heapPos[l.getId()] >= 0)
+                d.markDirty(l.getId());
+            else
+                d.heapInsert(l.getId());
+        }
+
+        d.level     = 0;
+        d.nextIndex = 0;
+    }
+
+    void makeTrail(uint32_t seed) {
+
+        std::vector<LID> order;
+
+        for (LID id = 1; id <= d.numVars; ++id)
+            order.push_back(id);
+
+        std::mt19937 rng(seed);
+
+        std::shuffle(order.begin(), order.end(), rng);
+
+        for (LID id: order) {
+
+            if (d.model[id] != UNDEF)
+                continue;
+
+            Lit l = Lit(id, rng() & 1 ? TRUE : FALSE);
+
+            decide(l);
+
+            if (d.propagateGivesConflict())
+                break;
+
+            trail.push_back(l);
+        }
+
+        undoAll();
+    }
+
+    void run(Micro& micro, const std::string& path, uint32_t seed) {
+
+        // Reading, indexing and scoring, as a solver does it
+        micro.run("dpll.load", "clause", [] () {}, [this, &path] () {
+
+            d.load(path);
+            return (uint64_t)d.clauses.size();
+        });
+
+        d.load(path);
+
+        makeTrail(seed);
+
+        micro.run("dpll.index", "clause", [this] () {
+
+            Dpll::recycle(d.binWatches);
+            Dpll::recycle(d.ternWatches);
+            Dpll::recycle(d.watches);
+        }, [this] () {
+
+            d.initClauseIndex();
+            return (uint64_t)d.clauses.size();
+        });
+
+        micro.run("dpll.occurs", "clause", [this] () {
+
+            Dpll::recycle(d.occurs);
+
+            d.assignedLits.clear();
+            d.score.clear();
+            d.heap.clear();
+            d.heapPos.clear();
+            d.dirty.clear();
+            d.isDirty.clear();
+            d.fixMark.clear();
+        }, [this] () {
+
+            d.initScores();
+            return (uint64_t)d.clauses.size();
+        });
+
+        // Assignments and their score updates included, as every descent of the search
+        micro.run("dpll.propagate", "propagation", [this] () { undoAll(); }, [this] () {
+
+            uint64_t before = d.propagations;
+
+            for (Lit l: trail) {
+
+                decide(l);
+                d.propagateGivesConflict();
+            }
+
+            return d.propagations - before;
+        });
+
+        // Every variable out of a freshly filled heap
+        micro.run("dpll.decide", "decision", [this] () {
+
+            undoAll();
+
+            for (LID id = 1; id <= d.numVars; ++id)
+                d.heapInsert(id);
+        }, [this] () {
+
+            uint64_t n = 0;
+
+            while (d.nextDecision() != 0)
+                ++n;
+
+            return n;
+        });
+
+        undoAll();
+    }
+};
+
+void benchDpll(Micro& micro, const std::string& path, uint32_t seed) {
+
+    if (not micro.selects("dpll."))
+        return;
+
+    DpllConfig config;
+
+    config.preprocess = {false, false, false};
+
+    Dpll d = Dpll(config);
+
+    DpllMicro(d).run(micro, path, seed);
+}
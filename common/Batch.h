@@ -0,0 +1,214 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_BATCH_H
+
+#include <algorithm>
+#include <exception>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Batch mode: many independent instances over a pool of threads, each
+// thread keeping one solver object that it reuses from an instance to the
+// next, so that its buffers stay allocated.
+//
+// Instances start largest file first: a long one started last would hold
+// the whole batch. Each gets the same time budget, after which it is
+// reported UNKNOWN. An instance whose solve throws, an unreadable file for
+// instance, is reported ERROR and the others go on.
+class Batch {
+
+public:
+
+    // Answer of one instance: 0 unknown, 1 satisfiable, 2 unsatisfiable, as
+    // the Result of both engines, or ERROR. work counts backtracks or conflicts.
+    static constexpr int ERROR = 3;
+
+    struct Outcome {
+
+        int      result;
+        uint64_t work;
+    };
+
+    // Worker id, path, and a test of the time budget (empty for none)
+    typedef std::function<Outcome(size_t, const std::string&, const std::function<bool()>&)> Solve;
+
+private:
+
+    struct Instance {
+
+        std::string path;
+        uintmax_t   bytes;
+    };
+
+    std::vector<Instance> instances;
+
+    size_t workers;
+
+    // Seconds per instance, 0 for no limit
+    double timeout;
+
+public:
+
+    // Files, every regular file of a directory, and the paths listed one per
+    // line in @file, in the order given, into paths. False if a list cannot
+    // be read, error then names it.
+    [[nodiscard]] static bool expand(const std::vector<std::string>& args, std::vector<std::string>& paths,
+                                     std::string& error) {
+
+        for (const std::string& arg: args) {
+
+            if (arg.size() > 1 && arg[0] == '@') {
+
+                std::ifstream list(arg.substr(1));
+
+                if (not list) {
+
+                    error = "cannot open list " + arg.substr(1);
+                    return false;
+                }
+
+                std::string line;
+
+                while (std::getline(list, line))
+                    if (not line.empty())
+                        paths.push_back(line);
+
+                continue;
+            }
+
+            std::error_code ec;
+
+            if (not std::filesystem::is_directory(arg, ec)) {
+
+                paths.push_back(arg);
+                continue;
+            }
+
+            std::vector<std::string> files;
+
+            for (const auto& entry: std::filesystem::directory_iterator(arg, ec))
+                if (entry.is_regular_file(ec))
+                    files.push_back(entry.path().string());
+
+            // Directory order is arbitrary
+            std::sort(files.begin(), files.end());
+
+            paths.insert(paths.end(), files.begin(), files.end());
+        }
+
+        return true;
+    }
+
+    // paths: as given by expand(). workers: 0 for one per hardware thread
+    Batch(const std::vector<std::string>& paths, size_t workers, double timeout)
+            : workers(workers), timeout(timeout) {
+
+        for (const std::string& path: paths) {
+
+            std::error_code ec;
+
+            uintmax_t bytes = std::filesystem::file_size(path, ec);
+
+            instances.push_back({path, ec ? 0 : bytes});
+        }
+
+        // Ties in size keep the order given
+        std::stable_sort(instances.begin(), instances.end(), [] (const Instance& a, const Instance& b) {
+
+            return a.bytes > b.bytes;
+        });
+
+        if (this->workers == 0)
+            this->workers = std::max(1u, std::thread::hardware_concurrency());
+
+        this->workers = std::max<size_t>(1, std::min(this->workers, instances.size()));
+    }
+
+    [[nodiscard]] inline size_t getWorkers() const {
+
+        return workers;
+    }
+
+    // One line per instance as it ends: path, answer, time and work (named
+    // workName), then the totals as a comment line
+    void run(std::ostream& os, const std::string& workName, const Solve& solve) {
+
+        static const char* names[] = {"UNKNOWN", "SATISFIABLE", "UNSATISFIABLE", "ERROR"};
+
+        std::atomic<size_t> next(0);
+        std::mutex          lock;
+
+        size_t   count[4] = {0, 0, 0, 0};
+        uint64_t work     = 0;
+        double   busy     = 0;
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::thread> threads;
+
+        for (size_t w = 0; w < workers; ++w)
+            threads.emplace_back([&, w] () {
+
+                for (size_t i = next.fetch_add(1); i < instances.size(); i = next.fetch_add(1)) {
+
+                    auto from = std::chrono::steady_clock::now();
+                    auto end  = from + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(timeout));
+
+                    std::function<bool()> expired;
+
+                    if (timeout > 0)
+                        expired = [end] () { return std::chrono::steady_clock::now() >= end; };
+
+                    Outcome res = {ERROR, 0};
+
+                    try {
+
+                        res = solve(w, instances[i].path, expired);
+                    }
+                    catch (const std::exception& e) {
+
+                        std::lock_guard<std::mutex> guard(lock);
+
+                        std::cerr << "c " << e.what() << std::endl;
+                    }
+
+                    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - from).count();
+
+                    std::lock_guard<std::mutex> guard(lock);
+
+                    ++count[res.result];
+                    work += res.work;
+                    busy += ms;
+
+                    os << instances[i].path << ' ' << names[res.result] << ' ' << ms << " ms " << res.work << ' '
+                       << workName << std::endl;
+                }
+            });
+
+        for (std::thread& t: threads)
+            t.join();
+
+        double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        os << "c batch " << instances.size() << " instances, " << count[1] << " sat, " << count[2] << " unsat, "
+           << count[0] << " unknown, " << count[ERROR] << " errors, " << workers << " threads, " << wall << " s, " << busy / 1000
+           << " s solving, " << (double)instances.size() / std::max(wall, 1e-9) << " instances/s, " << work
+           << ' ' << workName << std::endl;
+    }
+};
+
+#define LI_SAT_SOLVER_BATCH_H
+
+#endif //LI_SAT_SOLVER_BATCH_H
@@ -0,0 +1,206 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_CLAUSEARENA_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <type_traits>
+
+// Reference to a clause: offset of its header in the arena
+typedef uint32_t CRef;
+
+constexpr CRef CRef_Undef = UINT32_MAX;
+
+// All the clauses of a solver in one contiguous block of 32-bit words:
+//
+//   [size | flags] [lbd] ([activity] if learnt) [lit 0] ... [lit size - 1]
+//
+// Lit must be a 32-bit literal code. Freed clauses stay in place until
+// garbage collection moves the live ones into a fresh arena.
+template <class Lit>
+class ClauseArena {
+
+    static_assert(sizeof(Lit) == sizeof(uint32_t) && std::is_trivially_copyable<Lit>::value,
+                  "literals must be 32-bit codes");
+
+private:
+
+    static constexpr uint32_t SIZE_BITS = 24;
+    static constexpr uint32_t SIZE_MASK = (1u << SIZE_BITS) - 1;
+
+    static constexpr uint32_t LEARNT  = 1u << 24;
+    static constexpr uint32_t DELETED = 1u << 25;
+    static constexpr uint32_t RELOCED = 1u << 26;
+    static constexpr uint32_t EXTRA_SHIFT = 27;
+
+    std::vector<uint32_t> mem;
+
+    size_t wasted_;
+
+    [[nodiscard]] inline uint32_t headerSize(CRef cr) const {
+
+        return 2 + ((mem[cr] & LEARNT) != 0);
+    }
+
+public:
+
+    static constexpr size_t MAX_SIZE = SIZE_MASK;
+
+    ClauseArena() : wasted_(0) {}
+
+    template <class It>
+    CRef alloc(It first, It last, bool learnt) {
+
+        auto cr = (CRef)mem.size();
+        auto n  = (uint32_t)(last - first);
+
+        // Longer would overflow into the flags
+        assert((size_t)(last - first) <= MAX_SIZE);
+
+        mem.push_back(n | (learnt ? LEARNT : 0));
+        mem.push_back(0);
+
+        if (learnt)
+            mem.push_back(0);
+
+        for (; first != last; ++first)
+            mem.push_back(reinterpret_cast<const uint32_t&>(*first));
+
+        return cr;
+    }
+
+    [[nodiscard]] inline uint32_t size(CRef cr) const {
+
+        return mem[cr] & SIZE_MASK;
+    }
+
+    [[nodiscard]] inline Lit* begin(CRef cr) {
+
+        return reinterpret_cast<Lit*>(&mem[cr + headerSize(cr)]);
+    }
+
+    [[nodiscard]] inline Lit* end(CRef cr) {
+
+        return begin(cr) + size(cr);
+    }
+
+    [[nodiscard]] inline const Lit* begin(CRef cr) const {
+
+        return reinterpret_cast<const Lit*>(&mem[cr + headerSize(cr)]);
+    }
+
+    [[nodiscard]] inline const Lit* end(CRef cr) const {
+
+        return begin(cr) + size(cr);
+    }
+
+    [[nodiscard]] inline bool learnt(CRef cr) const {
+
+        return mem[cr] & LEARNT;
+    }
+
+    [[nodiscard]] inline bool deleted(CRef cr) const {
+
+        return mem[cr] & DELETED;
+    }
+
+    // Five spare header bits for the solver (tiers, usage marks)
+    [[nodiscard]] inline uint32_t extra(CRef cr) const {
+
+        return mem[cr] >> EXTRA_SHIFT;
+    }
+
+    inline void setExtra(CRef cr, uint32_t e) {
+
+        mem[cr] = (mem[cr] & ((1u << EXTRA_SHIFT) - 1)) | (e << EXTRA_SHIFT);
+    }
+
+    [[nodiscard]] inline uint32_t lbd(CRef cr) const {
+
+        return mem[cr + 1];
+    }
+
+    inline void setLbd(CRef cr, uint32_t l) {
+
+        mem[cr + 1] = l;
+    }
+
+    // Only learnt clauses carry an activity
+    [[nodiscard]] inline float& activity(CRef cr) {
+
+        return reinterpret_cast<float&>(mem[cr + 2]);
+    }
+
+    // Shrink a clause in place, the tail becomes garbage
+    inline void shrink(CRef cr, uint32_t n) {
+
+        wasted_ += size(cr) - n;
+        mem[cr] = (mem[cr] & ~SIZE_MASK) | n;
+    }
+
+    inline void free(CRef cr) {
+
+        if (deleted(cr))
+            return;
+
+        mem[cr] |= DELETED;
+        wasted_ += headerSize(cr) + size(cr);
+    }
+
+    // Copy cr into to (once) and return its new reference
+    CRef relocTo(ClauseArena& to, CRef cr) {
+
+        if (mem[cr] & RELOCED)
+            return mem[cr + 1];
+
+        CRef moved = to.alloc(begin(cr), end(cr), learnt(cr));
+
+        to.setExtra(moved, extra(cr));
+        to.setLbd(moved, lbd(cr));
+
+        if (learnt(cr))
+            to.activity(moved) = activity(cr);
+
+        mem[cr] |= RELOCED;
+        mem[cr + 1] = moved;
+
+        return moved;
+    }
+
+    [[nodiscard]] inline size_t wasted() const {
+
+        return wasted_;
+    }
+
+    // Size in words, garbage included
+    [[nodiscard]] inline size_t words() const {
+
+        return mem.size();
+    }
+
+    inline void reserve(size_t n) {
+
+        mem.reserve(n);
+    }
+
+    inline void clear() {
+
+        mem.clear();
+        wasted_ = 0;
+    }
+
+    void moveTo(ClauseArena& to) {
+
+        to.mem.swap(mem);
+        to.wasted_ = wasted_;
+
+        clear();
+    }
+};
+
+#define LI_SAT_SOLVER_CLAUSEARENA_H
+
+#endif //LI_SAT_SOLVER_CLAUSEARENA_H
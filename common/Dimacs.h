@@ -0,0 +1,644 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_DIMACS_H
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef LI_SAT_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef LI_SAT_HAVE_LZMA
+#include <lzma.h>
+#endif
+
+// DIMACS CNF reader. Regular files (stdin included) are mapped and scanned in
+// place, anything else is read in large blocks. gzip and xz inputs are
+// recognised by their magic bytes and decompressed on the fly.
+//
+// Clauses are handed out as they are read, so the caller can move them
+// straight into its clause store. The header is only a hint: more clauses,
+// fewer clauses, more or fewer variables than declared and a missing final 0
+// are accepted with a warning on stderr. Anything else throws an Error,
+// the caller decides what becomes of the process.
+class DimacsReader {
+
+public:
+
+    // Unreadable or malformed input, the message starts with the file name
+    // and the line
+    class Error : public std::runtime_error {
+
+    public:
+
+        explicit Error(const std::string& msg) : std::runtime_error(msg) {}
+    };
+
+    // Largest variable: 2 * var + 1 has to fit a 32-bit literal code
+    static constexpr uint64_t MAX_VARS = INT32_MAX;
+
+    // Longest clause: its size has to fit the 24-bit field of ClauseArena
+    static constexpr size_t MAX_CLAUSE = ((size_t)1 << 24) - 1;
+
+    struct Result {
+
+        bool     header        = false;
+        uint64_t headerVars    = 0;
+        uint64_t headerClauses = 0;
+
+        uint64_t maxVar  = 0;
+        uint64_t clauses = 0;
+
+        // Variables to allocate: the highest one used. The header is not
+        // trusted for it, a typo there would allocate gigabytes for nothing.
+        [[nodiscard]] inline uint64_t vars() const {
+
+            return maxVar;
+        }
+    };
+
+private:
+
+    enum Format {
+        PLAIN,
+        GZIP,
+        XZ
+    };
+
+    static constexpr size_t BLOCK = (size_t)1 << 20;
+
+    std::string name;
+
+    int  fd;
+    bool ownFd;
+
+    // Whole input when mapped
+    const char* map;
+    size_t      mapSize;
+    bool        mapDone;
+
+    // Raw (possibly compressed) bytes not handed out yet
+    std::vector<char> raw;
+    const char*       rawPos;
+    const char*       rawEnd;
+    bool              rawEof;
+
+    Format            format;
+    std::vector<char> out;
+    bool              streamEnd;
+
+#ifdef LI_SAT_HAVE_ZLIB
+    z_stream zs{};
+#endif
+
+#ifdef LI_SAT_HAVE_LZMA
+    lzma_stream xs = LZMA_STREAM_INIT;
+#endif
+
+    // Decoded bytes being scanned
+    const char* pos;
+    const char* end;
+
+    uint64_t line;
+
+    [[noreturn]] void fail(const std::string& msg) const {
+
+        throw Error(name + (line > 0 ? ':' + std::to_string(line) : "") + ": " + msg);
+    }
+
+    void release() {
+
+#ifdef LI_SAT_HAVE_ZLIB
+        if (format == GZIP)
+            inflateEnd(&zs);
+#endif
+#ifdef LI_SAT_HAVE_LZMA
+        if (format == XZ)
+            lzma_end(&xs);
+#endif
+
+        if (map != nullptr)
+            munmap((void*)map, mapSize);
+
+        if (ownFd)
+            ::close(fd);
+    }
+
+    void warn(const std::string& msg) const {
+
+        std::cerr << "c warning: " << name << ": " << msg << std::endl;
+    }
+
+    // Next raw bytes into [rawPos, rawEnd), false at the end of the input
+    bool moreRaw() {
+
+        if (map != nullptr) {
+
+            if (mapDone)
+                return false;
+
+            rawPos  = map;
+            rawEnd  = map + mapSize;
+            mapDone = true;
+
+            return true;
+        }
+
+        if (rawEof)
+            return false;
+
+        ssize_t n;
+
+        do
+            n = ::read(fd, raw.data(), raw.size());
+        while (n < 0 && errno == EINTR);
+
+        if (n < 0)
+            fail(std::string("read error: ") + std::strerror(errno));
+
+        if (n == 0) {
+            rawEof = true;
+            return false;
+        }
+
+        rawPos = raw.data();
+        rawEnd = raw.data() + n;
+
+        return true;
+    }
+
+    // Enough raw bytes at the start to tell the format, short reads from pipes included
+    void prime() {
+
+        if (not moreRaw() || map != nullptr)
+            return;
+
+        auto got = (size_t)(rawEnd - rawPos);
+
+        while (got < 6) {
+
+            ssize_t n = ::read(fd, raw.data() + got, raw.size() - got);
+
+            if (n < 0 && errno == EINTR)
+                continue;
+
+            if (n <= 0)
+                break;
+
+            got += (size_t)n;
+        }
+
+        rawEnd = raw.data() + got;
+    }
+
+    void detectFormat() {
+
+        auto size = (size_t)(rawEnd - rawPos);
+
+        auto* b = (const unsigned char*)rawPos;
+
+        if (size >= 2 && b[0] == 0x1f && b[1] == 0x8b)
+            format = GZIP;
+        else if (size >= 6 && std::memcmp(b, "\xfd" "7zXZ\0", 6) == 0)
+            format = XZ;
+        else
+            format = PLAIN;
+
+        switch (format) {
+
+            case GZIP:
+#ifdef LI_SAT_HAVE_ZLIB
+                // 15 + 32: any window size, gzip or zlib header
+                if (inflateInit2(&zs, 15 + 32) != Z_OK)
+                    fail("cannot initialise zlib");
+                break;
+#else
+                fail("gzip input, but built without zlib");
+#endif
+            case XZ:
+#ifdef LI_SAT_HAVE_LZMA
+                if (lzma_stream_decoder(&xs, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK)
+                    fail("cannot initialise liblzma");
+                break;
+#else
+                fail("xz input, but built without liblzma");
+#endif
+            default:
+                return;
+        }
+
+        out = std::vector<char>(BLOCK);
+    }
+
+    // Raw bytes for a decompressor, at most limit at a time
+    bool takeRaw(const char*& data, size_t& size, size_t limit) {
+
+        if (rawPos == rawEnd && not moreRaw())
+            return false;
+
+        size = std::min((size_t)(rawEnd - rawPos), limit);
+        data = rawPos;
+
+        rawPos += size;
+
+        return true;
+    }
+
+#ifdef LI_SAT_HAVE_ZLIB
+    bool inflateMore() {
+
+        while (not streamEnd) {
+
+            if (zs.avail_in == 0) {
+
+                const char* data;
+                size_t      size;
+
+                if (takeRaw(data, size, UINT_MAX)) {
+
+                    zs.next_in  = (Bytef*)data;
+                    zs.avail_in = (uInt)size;
+                }
+            }
+
+            zs.next_out  = (Bytef*)out.data();
+            zs.avail_out = (uInt)out.size();
+
+            int ret = inflate(&zs, Z_NO_FLUSH);
+
+            auto produced = (size_t)(out.size() - zs.avail_out);
+
+            if (ret == Z_STREAM_END) {
+
+                // Concatenated gzip members continue the same text
+                if (zs.avail_in > 0 || rawPos != rawEnd || moreRaw()) {
+
+                    if (zs.avail_in == 0) {
+
+                        zs.next_in  = (Bytef*)rawPos;
+                        zs.avail_in = (uInt)std::min((size_t)(rawEnd - rawPos), (size_t)UINT_MAX);
+                        rawPos += zs.avail_in;
+                    }
+
+                    inflateReset(&zs);
+                } else
+                    streamEnd = true;
+            } else if (ret == Z_BUF_ERROR && zs.avail_in == 0 && produced == 0)
+                fail("truncated gzip input");
+            else if (ret != Z_OK && ret != Z_BUF_ERROR)
+                fail("corrupt gzip input");
+
+            if (produced > 0) {
+
+                pos = out.data();
+                end = out.data() + produced;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+#endif
+
+#ifdef LI_SAT_HAVE_LZMA
+    bool unxzMore() {
+
+        while (not streamEnd) {
+
+            lzma_action action = LZMA_RUN;
+
+            if (xs.avail_in == 0) {
+
+                const char* data;
+                size_t      size;
+
+                if (takeRaw(data, size, SIZE_MAX)) {
+
+                    xs.next_in  = (const uint8_t*)data;
+                    xs.avail_in = size;
+                } else
+                    action = LZMA_FINISH;
+            }
+
+            xs.next_out  = (uint8_t*)out.data();
+            xs.avail_out = out.size();
+
+            lzma_ret ret = lzma_code(&xs, action);
+
+            auto produced = (size_t)(out.size() - xs.avail_out);
+
+            if (ret == LZMA_STREAM_END)
+                streamEnd = true;
+            else if (ret != LZMA_OK)
+                fail("corrupt or truncated xz input");
+
+            if (produced > 0) {
+
+                pos = out.data();
+                end = out.data() + produced;
+
+                return true;
+            }
+        }
+
+        return false;
+    }
+#endif
+
+    // Next decoded bytes into [pos, end), false at the end of the input
+    bool refill() {
+
+        switch (format) {
+
+#ifdef LI_SAT_HAVE_ZLIB
+            case GZIP:
+                return inflateMore();
+#endif
+#ifdef LI_SAT_HAVE_LZMA
+            case XZ:
+                return unxzMore();
+#endif
+            default:
+
+                // Plain bytes are scanned where they are
+                if (rawPos == rawEnd && not moreRaw())
+                    return false;
+
+                pos = rawPos;
+                end = rawEnd;
+
+                rawPos = rawEnd;
+
+                return true;
+        }
+    }
+
+    // Current character, -1 at the end of the input
+    inline int peek() {
+
+        if (pos == end && not refill())
+            return -1;
+
+        return (unsigned char)*pos;
+    }
+
+    inline void advance() {
+
+        ++pos;
+    }
+
+    // Skip blanks and newlines, return the next character
+    int skipSpace() {
+
+        while (true) {
+
+            int c = peek();
+
+            if (c == '\n')
+                ++line;
+            else if (c != ' ' && c != '\t' && c != '\r')
+                return c;
+
+            advance();
+        }
+    }
+
+    // Skip blanks on the current line, return the next character
+    int skipBlank() {
+
+        int c;
+
+        while ((c = peek()) == ' ' || c == '\t' || c == '\r')
+            advance();
+
+        return c;
+    }
+
+    void skipLine() {
+
+        int c;
+
+        while ((c = peek()) != '\n' && c != -1)
+            advance();
+    }
+
+    // Unsigned decimal number, at most max
+    uint64_t readNumber(uint64_t max, const char* what) {
+
+        auto d = (unsigned)(peek() - '0');
+
+        if (d > 9)
+            fail(std::string("expected ") + what);
+
+        uint64_t v = 0;
+
+        do {
+
+            if (v > (max - d) / 10)
+                fail(std::string(what) + " out of range");
+
+            v = 10 * v + d;
+
+            advance();
+
+            d = (unsigned)(peek() - '0');
+
+        } while (d <= 9);
+
+        int c = peek();
+
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != -1)
+            fail(std::string("unexpected character after ") + what);
+
+        return v;
+    }
+
+    void readHeader(Result& res) {
+
+        if (res.header)
+            fail("duplicate header");
+
+        advance();
+
+        skipBlank();
+
+        for (const char* w = "cnf"; *w; ++w, advance())
+            if (peek() != *w)
+                fail("expected \"p cnf <variables> <clauses>\"");
+
+        skipBlank();
+        res.headerVars = readNumber(MAX_VARS, "variable count");
+
+        skipBlank();
+        res.headerClauses = readNumber(UINT64_MAX, "clause count");
+
+        res.header = true;
+
+        int c = skipBlank();
+
+        if (c != '\n' && c != -1)
+            fail("unexpected text after the header");
+    }
+
+public:
+
+    // An empty path or "-" reads stdin
+    explicit DimacsReader(const std::string& path)
+            : name(path.empty() || path == "-" ? "<stdin>" : path), fd(0), ownFd(false),
+              map(nullptr), mapSize(0), mapDone(false), rawPos(nullptr), rawEnd(nullptr), rawEof(false),
+              format(PLAIN), streamEnd(false), pos(nullptr), end(nullptr), line(1) {
+
+        if (not (path.empty() || path == "-")) {
+
+            fd = ::open(path.c_str(), O_RDONLY);
+
+            if (fd < 0) {
+                line = 0;
+                fail(std::string("cannot open: ") + std::strerror(errno));
+            }
+
+            ownFd = true;
+        }
+
+        struct stat st{};
+
+        // Map regular files read from the start, stdin redirections included
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0 && lseek(fd, 0, SEEK_CUR) == 0) {
+
+            void* m = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (m != MAP_FAILED) {
+
+                madvise(m, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+                map     = (const char*)m;
+                mapSize = (size_t)st.st_size;
+            }
+        }
+
+        if (map == nullptr)
+            raw = std::vector<char>(BLOCK);
+
+        // No destructor runs when the constructor throws
+        try {
+
+            prime();
+            detectFormat();
+        }
+        catch (const Error&) {
+
+            release();
+            throw;
+        }
+    }
+
+    DimacsReader(const DimacsReader&) = delete;
+    DimacsReader& operator=(const DimacsReader&) = delete;
+
+    ~DimacsReader() {
+
+        release();
+    }
+
+    // Read the whole input. make(lit) turns a non zero DIMACS literal into a
+    // Lit, onClause(lits) receives every clause as a vector of them.
+    template <class Lit, class Make, class OnClause>
+    Result read(Make make, OnClause onClause) {
+
+        Result res;
+
+        std::vector<Lit> lits;
+
+        while (true) {
+
+            int c = skipSpace();
+
+            if (c == -1)
+                break;
+
+            if (c == 'c') {
+                skipLine();
+                continue;
+            }
+
+            if (c == 'p') {
+                readHeader(res);
+                continue;
+            }
+
+            // SATLIB end marker, the rest of the file is not CNF
+            if (c == '%')
+                break;
+
+            bool neg = c == '-';
+
+            if (neg)
+                advance();
+
+            auto var = readNumber(MAX_VARS, "literal");
+
+            if (var == 0) {
+
+                if (neg)
+                    fail("\"-0\" is not a literal");
+
+                onClause(lits);
+                lits.clear();
+
+                ++res.clauses;
+                continue;
+            }
+
+            res.maxVar = std::max(res.maxVar, var);
+
+            if (lits.size() == MAX_CLAUSE)
+                fail("clause longer than " + std::to_string(MAX_CLAUSE) + " literals");
+
+            lits.push_back(make(neg ? -(int)var : (int)var));
+        }
+
+        if (not lits.empty()) {
+
+            warn("last clause is not terminated by 0");
+
+            onClause(lits);
+            ++res.clauses;
+        }
+
+        if (not res.header)
+            warn("no \"p cnf\" header");
+        else {
+
+            if (res.maxVar != res.headerVars)
+                warn("header declares " + std::to_string(res.headerVars) + " variables, found " +
+                     std::to_string(res.maxVar));
+
+            if (res.clauses != res.headerClauses)
+                warn("header declares " + std::to_string(res.headerClauses) + " clauses, found " +
+                     std::to_string(res.clauses));
+        }
+
+        return res;
+    }
+};
+
+#define LI_SAT_SOLVER_DIMACS_H
+
+#endif //LI_SAT_SOLVER_DIMACS_H
@@ -0,0 +1,383 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_LOCALSEARCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Stochastic local search (ProbSAT) on DIMACS literals (var or -var).
+//
+// A complete assignment is repaired one flip at a time: a random falsified
+// clause is picked, and one of its variables is flipped with probability
+// proportional to f(break), break being the number of clauses that would
+// become false. f is polynomial (eps + break)^-cb on 3-SAT and exponential
+// cb^-break on longer clauses, with the constants of Balint and Schoening.
+//
+// Per clause the number of true literals and the xor of their variables
+// are kept, so the only true variable of a critical clause is known
+// without looking at the clause. Break counts are updated on every flip,
+// and the falsified clauses are in a list with O(1) removal.
+class LocalSearch {
+
+private:
+
+    // Break values past this one share its probability
+    static constexpr uint32_t MAX_BREAK = 64;
+
+    int numVars;
+
+    // Clause literals back to back, clause c is lits[start[c] .. start[c + 1])
+    std::vector<int>      lits;
+    std::vector<uint32_t> start;
+
+    // occurs[occStart[litIndex(l)] ..]: clauses that contain l, built by init()
+    std::vector<uint32_t> occStart;
+    std::vector<uint32_t> occurs;
+
+    // Current assignment, 1 or -1 per variable
+    std::vector<int8_t> values;
+
+    // Per clause: true literals, and xor of their variables
+    std::vector<uint32_t> numTrue;
+    std::vector<uint32_t> trueXor;
+
+    // Per variable: clauses it is the only true literal of
+    std::vector<uint32_t> breaks;
+
+    // Falsified clauses, unsatPos[c] is the position of c in unsat
+    std::vector<uint32_t> unsat;
+    std::vector<uint32_t> unsatPos;
+
+    std::vector<double> probs;
+
+    // Assignment with the fewest falsified clauses of the last walk. The
+    // flips since are in bestTrail, or trailFull if there are too many.
+    std::vector<int8_t> best;
+    std::vector<int>    bestTrail;
+    bool                trailFull;
+    size_t              bestUnsat;
+
+    size_t   maxLength;
+    bool     empty;
+    bool     ready;
+    uint64_t flips;
+
+    std::mt19937 rng;
+
+    [[nodiscard]] static inline size_t litIndex(int l) {
+
+        return 2 * (size_t)std::abs(l) + (l < 0);
+    }
+
+    [[nodiscard]] inline bool isTrue(int l) const {
+
+        return values[std::abs(l)] == (l > 0 ? 1 : -1);
+    }
+
+    inline void addUnsat(uint32_t c) {
+
+        unsatPos[c] = (uint32_t)unsat.size();
+        unsat.push_back(c);
+    }
+
+    inline void removeUnsat(uint32_t c) {
+
+        uint32_t last = unsat.back();
+
+        unsat[unsatPos[c]] = last;
+        unsatPos[last]     = unsatPos[c];
+
+        unsat.pop_back();
+    }
+
+    // Occurrence lists and probabilities, once every clause is in
+    void init() {
+
+        ready = true;
+
+        auto numClauses = (uint32_t)(start.size() - 1);
+
+        occStart = std::vector<uint32_t>(2 * ((size_t)numVars + 1) + 1, 0);
+
+        for (int l: lits)
+            ++occStart[litIndex(l) + 1];
+
+        for (size_t i = 1; i < occStart.size(); ++i)
+            occStart[i] += occStart[i - 1];
+
+        occurs = std::vector<uint32_t>(lits.size());
+
+        std::vector<uint32_t> fill = std::vector<uint32_t>(occStart.begin(), occStart.end() - 1);
+
+        for (uint32_t c = 0; c < numClauses; ++c)
+            for (uint32_t k = start[c]; k < start[c + 1]; ++k)
+                occurs[fill[litIndex(lits[k])]++] = c;
+
+        numTrue  = std::vector<uint32_t>(numClauses, 0);
+        trueXor  = std::vector<uint32_t>(numClauses, 0);
+        unsatPos = std::vector<uint32_t>(numClauses, 0);
+
+        probs = std::vector<double>(MAX_BREAK + 1);
+
+        for (uint32_t b = 0; b <= MAX_BREAK; ++b) {
+
+            if (maxLength <= 3)
+                probs[b] = std::pow(1.0 + b, -2.38);
+            else {
+
+                double cb = maxLength == 4 ? 3.0 : maxLength == 5 ? 3.7 : maxLength == 6 ? 5.1 : 5.4;
+
+                probs[b] = std::pow(cb, -(double)b);
+            }
+        }
+    }
+
+    // Counters of every clause from scratch, for the current assignment
+    void count() {
+
+        std::fill(breaks.begin(), breaks.end(), 0);
+
+        unsat.clear();
+
+        for (uint32_t c = 0; c + 1 < start.size(); ++c) {
+
+            uint32_t n = 0;
+            uint32_t x = 0;
+
+            for (uint32_t k = start[c]; k < start[c + 1]; ++k)
+                if (isTrue(lits[k])) {
+
+                    ++n;
+                    x ^= (uint32_t)std::abs(lits[k]);
+                }
+
+            numTrue[c] = n;
+            trueXor[c] = x;
+
+            if (n == 0)
+                addUnsat(c);
+            else if (n == 1)
+                ++breaks[x];
+        }
+    }
+
+    void flip(int var) {
+
+        values[var] = (int8_t)-values[var];
+
+        int now = values[var] > 0 ? var : -var;
+
+        for (uint32_t i = occStart[litIndex(now)]; i < occStart[litIndex(now) + 1]; ++i) {
+
+            uint32_t c = occurs[i];
+
+            uint32_t n = numTrue[c]++;
+
+            if (n == 0) {
+
+                removeUnsat(c);
+                ++breaks[var];
+            }
+            else if (n == 1)
+                --breaks[trueXor[c]];
+
+            trueXor[c] ^= (uint32_t)var;
+        }
+
+        for (uint32_t i = occStart[litIndex(-now)]; i < occStart[litIndex(-now) + 1]; ++i) {
+
+            uint32_t c = occurs[i];
+
+            uint32_t n = --numTrue[c];
+
+            trueXor[c] ^= (uint32_t)var;
+
+            if (n == 0) {
+
+                addUnsat(c);
+                --breaks[var];
+            }
+            else if (n == 1)
+                ++breaks[trueXor[c]];
+        }
+    }
+
+    // Bring best up to the current assignment
+    void saveBest() {
+
+        if (trailFull)
+            best = values;
+        else
+            for (int var: bestTrail)
+                best[var] = values[var];
+
+        bestTrail.clear();
+        trailFull = false;
+
+        bestUnsat = unsat.size();
+    }
+
+    void recordFlip(int var) {
+
+        if (trailFull)
+            return;
+
+        bestTrail.push_back(var);
+
+        // Past one flip per variable a full copy is cheaper
+        if (bestTrail.size() > (size_t)numVars) {
+
+            bestTrail.clear();
+            trailFull = true;
+        }
+    }
+
+    // Uniform in [0, 1)
+    [[nodiscard]] inline double uniform() {
+
+        return (double)rng() * (1.0 / 4294967296.0);
+    }
+
+public:
+
+    explicit LocalSearch(int numVars = 0, uint32_t seed = 0)
+            : numVars(numVars), trailFull(false), bestUnsat(SIZE_MAX), maxLength(0), empty(false), ready(false),
+              flips(0), rng(seed) {
+
+        start  = std::vector<uint32_t>(1, 0);
+        values = std::vector<int8_t>((size_t)numVars + 1, 1);
+
+        values[0] = 0;
+        breaks = std::vector<uint32_t>((size_t)numVars + 1, 0);
+        best   = values;
+    }
+
+    // Duplicate literals are merged and tautologies dropped
+    void addClause(std::vector<int> c) {
+
+        std::sort(c.begin(), c.end(), [] (int a, int b) {
+
+            return std::abs(a) != std::abs(b) ? std::abs(a) < std::abs(b) : a < b;
+        });
+
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+
+        for (size_t i = 1; i < c.size(); ++i)
+            if (c[i] == -c[i - 1])
+                return;
+
+        if (c.empty())
+            empty = true;
+
+        lits.insert(lits.end(), c.begin(), c.end());
+        start.push_back((uint32_t)lits.size());
+
+        maxLength = std::max(maxLength, c.size());
+    }
+
+    // Starting assignment: pick(var) gives 1, -1, or 0 for a random value
+    template <class Pick>
+    void load(Pick pick) {
+
+        for (int var = 1; var <= numVars; ++var) {
+
+            int8_t v = pick(var);
+
+            values[var] = v != 0 ? v : rng() & 1 ? 1 : -1;
+        }
+    }
+
+    // Flip until every clause is satisfied, true then, or maxFlips flips
+    // (0 for no limit). The best assignment seen is kept, see getBest().
+    bool walk(uint64_t maxFlips) {
+
+        if (empty)
+            return false;
+
+        if (not ready)
+            init();
+
+        count();
+
+        best = values;
+        bestTrail.clear();
+        trailFull = false;
+        bestUnsat = unsat.size();
+
+        std::vector<double> weights;
+
+        for (uint64_t n = 0; not unsat.empty() && (maxFlips == 0 || n < maxFlips); ++n) {
+
+            uint32_t c = unsat[rng() % unsat.size()];
+
+            double sum = 0;
+
+            weights.clear();
+
+            for (uint32_t k = start[c]; k < start[c + 1]; ++k) {
+
+                double w = probs[std::min(breaks[std::abs(lits[k])], MAX_BREAK)];
+
+                weights.push_back(w);
+                sum += w;
+            }
+
+            double r = uniform() * sum;
+
+            uint32_t k = start[c];
+
+            for (double w: weights) {
+
+                if (r < w || k + 1 == start[c + 1])
+                    break;
+
+                r -= w;
+                ++k;
+            }
+
+            int var = std::abs(lits[k]);
+
+            flip(var);
+            recordFlip(var);
+
+            ++flips;
+
+            if (unsat.size() < bestUnsat)
+                saveBest();
+        }
+
+        return unsat.empty();
+    }
+
+    // Value of a variable in the current assignment, a model after a successful walk
+    [[nodiscard]] inline int8_t value(int var) const {
+
+        return values[var];
+    }
+
+    // Best assignment of the last walk, indexed by variable (index 0 unused)
+    [[nodiscard]] inline const std::vector<int8_t>& getBest() const {
+
+        return best;
+    }
+
+    [[nodiscard]] inline size_t getBestUnsat() const {
+
+        return bestUnsat;
+    }
+
+    [[nodiscard]] inline uint64_t getFlips() const {
+
+        return flips;
+    }
+};
+
+#define LI_SAT_SOLVER_LOCALSEARCH_H
+
+#endif //LI_SAT_SOLVER_LOCALSEARCH_H
@@ -0,0 +1,139 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_OPTIONS_H
+
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+// Command line as --name=value pairs (a bare --name means "1") plus positional arguments
+class Options {
+
+private:
+
+    std::map<std::string, std::string> values;
+    std::vector<std::string>           positional;
+
+    // Names asked for so far, given or not
+    mutable std::set<std::string> known;
+
+    [[nodiscard]] std::map<std::string, std::string>::const_iterator find(const std::string& name) const {
+
+        known.insert(name);
+
+        return values.find(name);
+    }
+
+public:
+
+    Options(int argc, char** argv) {
+
+        for (int i = 1; i < argc; ++i) {
+
+            std::string arg = argv[i];
+
+            if (arg.rfind("--", 0) != 0) {
+                positional.push_back(arg);
+                continue;
+            }
+
+            size_t eq = arg.find('=');
+
+            if (eq == std::string::npos)
+                values[arg.substr(2)] = "1";
+            else
+                values[arg.substr(2, eq - 2)] = arg.substr(eq + 1);
+        }
+    }
+
+    [[nodiscard]] bool has(const std::string& name) const {
+
+        return find(name) != values.end();
+    }
+
+    [[nodiscard]] std::string get(const std::string& name, const std::string& def) const {
+
+        auto it = find(name);
+
+        return it == values.end() ? def : it->second;
+    }
+
+    [[nodiscard]] long long getInt(const std::string& name, long long def) const {
+
+        auto it = find(name);
+
+        if (it == values.end())
+            return def;
+
+        char* end;
+        long long v = std::strtoll(it->second.c_str(), &end, 10);
+
+        if (*end != '\0' || it->second.empty())
+            fail(name, it->second);
+
+        return v;
+    }
+
+    [[nodiscard]] double getDouble(const std::string& name, double def) const {
+
+        auto it = find(name);
+
+        if (it == values.end())
+            return def;
+
+        char* end;
+        double v = std::strtod(it->second.c_str(), &end);
+
+        if (*end != '\0' || it->second.empty())
+            fail(name, it->second);
+
+        return v;
+    }
+
+    // Value of name among choices, or its index in choices
+    [[nodiscard]] size_t choice(const std::string& name, const std::vector<std::string>& choices, size_t def) const {
+
+        auto it = find(name);
+
+        if (it == values.end())
+            return def;
+
+        for (size_t i = 0; i < choices.size(); ++i)
+            if (choices[i] == it->second)
+                return i;
+
+        fail(name, it->second);
+    }
+
+    // A misspelt option would otherwise be ignored: once every option of the
+    // program has been asked for, any other one given is an error
+    void rejectUnknown() const {
+
+        for (const auto& [name, value]: values)
+            if (known.count(name) == 0) {
+
+                std::cerr << "Unknown option --" << name << std::endl;
+                exit(1);
+            }
+    }
+
+    [[nodiscard]] const std::vector<std::string>& getPositional() const {
+
+        return positional;
+    }
+
+    [[noreturn]] static void fail(const std::string& name, const std::string& value) {
+
+        std::cerr << "Invalid value for --" << name << ": " << value << std::endl;
+        exit(1);
+    }
+};
+
+#define LI_SAT_SOLVER_OPTIONS_H
+
+#endif //LI_SAT_SOLVER_OPTIONS_H
@@ -0,0 +1,258 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_PHASE_H
+
+#include "Options.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Decision polarities, as LST values (1 true, -1 false).
+//
+//   saved:  value of the variable when it was last unassigned
+//   target: values on the longest trail since the last rephase (optional)
+//   best:   values on the longest trail so far
+//
+// Every so many conflicts the saved phases are reset following a schedule
+// of rephase kinds, cycled through in order. WALK is left to the engine,
+// which runs a local search from the saved phases and loads its best
+// assignment back.
+class Phases {
+
+public:
+
+    enum Kind {
+        ORIGINAL,
+        INVERTED,
+        RANDOM,
+        BEST,
+        WALK
+    };
+
+    // Runtime settings, see fromOptions()
+    struct Config {
+
+        bool              target   = false;
+        std::vector<Kind> schedule = {};
+        uint64_t          interval = 1000;
+        uint32_t          seed     = 0;
+
+        [[nodiscard]] inline bool walks() const {
+
+            return std::find(schedule.begin(), schedule.end(), WALK) != schedule.end();
+        }
+    };
+
+private:
+
+    std::vector<int8_t> saved;
+    std::vector<int8_t> target;
+    std::vector<int8_t> best;
+
+    size_t targetSize;
+    size_t bestSize;
+
+    int8_t original;
+    bool   useTarget;
+
+    std::vector<Kind> schedule;
+    size_t            next;
+
+    uint64_t nextRephase;
+    uint64_t interval;
+
+    std::mt19937 rng;
+
+public:
+
+    Phases(size_t num, int8_t original) : Phases(num, original, Config()) {}
+
+    Phases(size_t num, int8_t original, const Config& config)
+            : targetSize(0), bestSize(0), original(original), useTarget(config.target),
+              schedule(config.schedule), next(0),
+              nextRephase(config.interval), interval(config.interval), rng(config.seed) {
+
+        saved  = std::vector<int8_t>(num, original);
+        target = std::vector<int8_t>(num, 0);
+        best   = std::vector<int8_t>(num, 0);
+    }
+
+    // As constructed, over the memory already allocated
+    void reset(size_t num, int8_t orig, const Config& config) {
+
+        targetSize  = 0;
+        bestSize    = 0;
+        original    = orig;
+        useTarget   = config.target;
+        schedule    = config.schedule;
+        next        = 0;
+        nextRephase = config.interval;
+        interval    = config.interval;
+
+        rng.seed(config.seed);
+
+        saved.assign(num, orig);
+        target.assign(num, 0);
+        best.assign(num, 0);
+    }
+
+    // Parse a comma separated schedule (original,inverted,random,best,walk), "none" is empty
+    [[nodiscard]] static bool parseSchedule(const std::string& text, std::vector<Kind>& out) {
+
+        static const char* names[] = {"original", "inverted", "random", "best", "walk"};
+
+        out.clear();
+
+        if (text == "none" || text.empty())
+            return true;
+
+        std::stringstream ss(text);
+        std::string item;
+
+        while (std::getline(ss, item, ',')) {
+
+            size_t k = 0;
+
+            while (k < 5 && item != names[k])
+                ++k;
+
+            if (k == 5)
+                return false;
+
+            out.push_back((Kind)k);
+        }
+
+        return true;
+    }
+
+    // --phase=saved|target  --rephase=<schedule>  --rephase-interval=<conflicts>  --seed=<n>
+    [[nodiscard]] static Config fromOptions(const Options& opts, const std::string& defSchedule) {
+
+        Config config;
+
+        config.target = opts.choice("phase", {"saved", "target"}, 0) == 1;
+
+        std::string schedule = opts.get("rephase", defSchedule);
+
+        if (not parseSchedule(schedule, config.schedule))
+            Options::fail("rephase", schedule);
+
+        long long interval = opts.getInt("rephase-interval", (long long)config.interval);
+
+        if (interval <= 0)
+            Options::fail("rephase-interval", std::to_string(interval));
+
+        config.interval = (uint64_t)interval;
+        config.seed     = (uint32_t)opts.getInt("seed", 0);
+
+        return config;
+    }
+
+    // Room for num variables, the new ones start at the original phase
+    void grow(size_t num) {
+
+        saved.resize(num, original);
+        target.resize(num, 0);
+        best.resize(num, 0);
+    }
+
+    [[nodiscard]] inline int8_t pick(size_t id) const {
+
+        if (useTarget && target[id] != 0)
+            return target[id];
+
+        return saved[id];
+    }
+
+    inline void save(size_t id, int8_t value) {
+
+        saved[id] = value;
+    }
+
+    // Offer the current trail of n assignments; each(visit) calls visit(id, value)
+    // for all of them and is only run if the trail beats the target or the best one
+    template <class Each>
+    void record(size_t n, Each each) {
+
+        bool toTarget = useTarget && n > targetSize;
+        bool toBest   = n > bestSize;
+
+        if (not toTarget && not toBest)
+            return;
+
+        if (toTarget)
+            targetSize = n;
+
+        if (toBest)
+            bestSize = n;
+
+        each([this, toTarget, toBest] (size_t id, int8_t value) {
+
+            if (toTarget)
+                target[id] = value;
+
+            if (toBest)
+                best[id] = value;
+        });
+    }
+
+    [[nodiscard]] inline bool due(uint64_t conflicts) const {
+
+        return not schedule.empty() && conflicts >= nextRephase;
+    }
+
+    // Reset the saved phases with the next kind of the schedule
+    Kind rephase() {
+
+        Kind kind = schedule[next];
+
+        next = (next + 1) % schedule.size();
+
+        interval += interval / 2;
+        nextRephase += interval;
+
+        for (size_t id = 0; id < saved.size(); ++id)
+            switch (kind) {
+
+                case ORIGINAL:
+                    saved[id] = original;
+                    break;
+                case INVERTED:
+                    saved[id] = (int8_t)-original;
+                    break;
+                case RANDOM:
+                    saved[id] = rng() & 1 ? 1 : -1;
+                    break;
+                case BEST:
+                    if (best[id] != 0)
+                        saved[id] = best[id];
+                    break;
+                case WALK:
+                    break;
+            }
+
+        // The target starts over from the new phases
+        targetSize = 0;
+        std::fill(target.begin(), target.end(), 0);
+
+        return kind;
+    }
+
+    // Overwrite the saved phases, e.g. with a model found by another search
+    template <class It>
+    void load(It first, It last) {
+
+        for (size_t id = 0; first != last && id < saved.size(); ++first, ++id)
+            if (*first != 0)
+                saved[id] = *first;
+    }
+};
+
+#define LI_SAT_SOLVER_PHASE_H
+
+#endif //LI_SAT_SOLVER_PHASE_H
@@ -0,0 +1,976 @@
+//
+// Created by kepler-22b on 17/10/26.
+//
+
+#ifndef LI_SAT_SOLVER_PREPROCESS_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <vector>
+
+// Formula simplification before search, on DIMACS literals (var or -var).
+//
+// Subsumption: a clause C removes every clause D that contains it, and
+// strengthens D when C matches D but for one literal of opposite sign
+// (self-subsuming resolution removes that literal from D). Candidates D
+// come from the shortest occurrence list of a variable of C and are
+// filtered with 64-bit signatures of their variables first.
+//
+// Probing: the binary clauses form an implication graph over literals. Its
+// strongly connected components (Tarjan) are equivalent literals, each one
+// is replaced by a representative. Then roots of the graph are propagated
+// both ways: a literal whose propagation fails is fixed to false, and
+// literals implied by both polarities are fixed to what they are implied.
+// Fixed variables stay in the formula as unit clauses.
+//
+// Bounded variable elimination (SatELite): a variable x is replaced by all
+// the non tautological resolvents of its clauses on x, as long as there are
+// no more of them than the clauses they replace and none is too long.
+// Removed clauses go to a reconstruction stack, which extends a model of the
+// reduced formula to one of the original formula.
+class Preprocessor {
+
+public:
+
+    struct Limits {
+
+        // Extra clauses an elimination may add
+        int64_t  grow       = 0;
+        // Longest resolvent allowed
+        size_t   clauseLim  = 20;
+        // Variables with more occurrences are left alone
+        size_t   occLim     = 100;
+        // Literals visited while resolving, over the whole run
+        uint64_t stepLim    = 200000000;
+        // Literals visited while probing
+        uint64_t probeLim   = 20000000;
+    };
+
+    // Passes of run(), in this order
+    struct Passes {
+
+        bool subsume = true;
+        bool probe   = true;
+        bool elim    = true;
+
+        [[nodiscard]] inline bool any() const {
+
+            return subsume || probe || elim;
+        }
+    };
+
+private:
+
+    std::vector<std::vector<int>> clauses;
+    std::vector<char>             removed;
+
+    // One bit per variable modulo 64, a clause can only contain clauses whose signature it covers
+    std::vector<uint64_t> sigs;
+
+    // occurs[litIndex(l)]: clauses that contain l, removed ones dropped lazily
+    std::vector<std::vector<uint32_t>> occurs;
+
+    std::vector<char> eliminated_;
+
+    // Level 0 values found while preprocessing, 1, -1 or 0
+    std::vector<int8_t> fixed;
+
+    // Probing assignment on top of fixed, and its trail
+    std::vector<int8_t> probeVal;
+    std::vector<int>    probeTrail;
+
+    // Eliminated clauses, each one as its literals (the eliminated one first) then its size
+    std::vector<int> stack;
+
+    // Scratch: sign of the literal of each variable in the clause being built
+    std::vector<int8_t> mark;
+
+    std::vector<char> touchedMark;
+    std::vector<int>  touched;
+
+    // Scratch: elimination cost of the queued variables
+    std::vector<uint64_t> costs;
+
+    uint64_t steps;
+    bool     unsat;
+    bool     ran;
+
+    size_t numEliminated;
+    size_t numSubsumed;
+    size_t numStrengthened;
+    size_t numSubstituted;
+    size_t numFixed;
+
+    [[nodiscard]] static inline uint64_t signature(const std::vector<int>& c) {
+
+        uint64_t sig = 0;
+
+        for (int l: c)
+            sig |= (uint64_t)1 << (std::abs(l) & 63);
+
+        return sig;
+    }
+
+    [[nodiscard]] static inline size_t litIndex(int l) {
+
+        return 2 * (size_t)std::abs(l) + (l < 0);
+    }
+
+    void touch(int var) {
+
+        if (not touchedMark[var]) {
+            touchedMark[var] = 1;
+            touched.push_back(var);
+        }
+    }
+
+    // Live clauses containing l
+    std::vector<uint32_t>& occ(int l) {
+
+        std::vector<uint32_t>& os = occurs[litIndex(l)];
+
+        os.erase(std::remove_if(os.begin(), os.end(), [this] (uint32_t c) { return removed[c]; }), os.end());
+
+        return os;
+    }
+
+    void attach(std::vector<int>& c) {
+
+        auto ci = (uint32_t)clauses.size();
+
+        for (int l: c) {
+            occurs[litIndex(l)].push_back(ci);
+            touch(std::abs(l));
+        }
+
+        sigs.push_back(signature(c));
+        clauses.push_back(std::move(c));
+        removed.push_back(0);
+    }
+
+    void remove(uint32_t ci) {
+
+        removed[ci] = 1;
+
+        for (int l: clauses[ci])
+            touch(std::abs(l));
+
+        clauses[ci] = std::vector<int>();
+    }
+
+    // Resolvent of a (with x) and b (with -x) into out, false if tautological
+    bool resolve(const std::vector<int>& a, const std::vector<int>& b, int x, std::vector<int>& out) {
+
+        out.clear();
+
+        for (int l: a)
+            if (l != x) {
+                mark[std::abs(l)] = (int8_t)(l > 0 ? 1 : -1);
+                out.push_back(l);
+            }
+
+        bool taut = false;
+
+        for (int l: b) {
+
+            if (l == -x)
+                continue;
+
+            int8_t m = mark[std::abs(l)];
+
+            if (m == 0)
+                out.push_back(l);
+            else if (m != (l > 0 ? 1 : -1)) {
+                taut = true;
+                break;
+            }
+        }
+
+        for (int l: a)
+            mark[std::abs(l)] = 0;
+
+        steps += a.size() + b.size();
+
+        return not taut;
+    }
+
+    void pushElim(const std::vector<int>& c, int pivot) {
+
+        stack.push_back(pivot);
+
+        for (int l: c)
+            if (l != pivot)
+                stack.push_back(l);
+
+        stack.push_back((int)c.size());
+    }
+
+    bool tryEliminate(int x, const Limits& lim) {
+
+        // Copies, the lists change as clauses are removed and resolvents added
+        std::vector<uint32_t> pos = occ(x);
+        std::vector<uint32_t> neg = occ(-x);
+
+        if (pos.empty() && neg.empty())
+            return false;
+
+        if (pos.size() + neg.size() > lim.occLim)
+            return false;
+
+        std::vector<std::vector<int>> resolvents;
+        std::vector<int>              r;
+
+        auto bound = (int64_t)(pos.size() + neg.size()) + lim.grow;
+
+        for (uint32_t p: pos)
+            for (uint32_t n: neg) {
+
+                if (not resolve(clauses[p], clauses[n], x, r))
+                    continue;
+
+                if (r.size() > lim.clauseLim || (int64_t)resolvents.size() + 1 > bound)
+                    return false;
+
+                resolvents.push_back(r);
+            }
+
+        // Keep the smaller side, with the opposite unit as the default value
+        if (pos.size() > neg.size()) {
+
+            for (uint32_t n: neg)
+                pushElim(clauses[n], -x);
+
+            stack.push_back(x);
+            stack.push_back(1);
+        } else {
+
+            for (uint32_t p: pos)
+                pushElim(clauses[p], x);
+
+            stack.push_back(-x);
+            stack.push_back(1);
+        }
+
+        for (uint32_t c: pos)
+            remove(c);
+
+        for (uint32_t c: neg)
+            remove(c);
+
+        eliminated_[x] = 1;
+        ++numEliminated;
+
+        for (std::vector<int>& c: resolvents) {
+
+            if (c.empty()) {
+                unsat = true;
+                return true;
+            }
+
+            attach(c);
+        }
+
+        return true;
+    }
+
+    // Remove l from clause ci
+    void strengthen(uint32_t ci, int l) {
+
+        std::vector<int>& c = clauses[ci];
+
+        c.erase(std::find(c.begin(), c.end(), l));
+
+        std::vector<uint32_t>& os = occurs[litIndex(l)];
+        os.erase(std::find(os.begin(), os.end(), ci));
+
+        sigs[ci] = signature(c);
+
+        for (int k: c)
+            touch(std::abs(k));
+
+        if (c.empty())
+            unsat = true;
+    }
+
+    // Use clause ci to remove or strengthen others, the strengthened ones go to queue
+    void backward(uint32_t ci, std::vector<uint32_t>& queue) {
+
+        const std::vector<int>& c = clauses[ci];
+
+        if (c.empty())
+            return;
+
+        // Every candidate contains the variable of c with the fewest occurrences
+        int best = c[0];
+
+        for (int l: c)
+            if (occurs[litIndex(l)].size() + occurs[litIndex(-l)].size() <
+                occurs[litIndex(best)].size() + occurs[litIndex(-best)].size())
+                best = l;
+
+        for (int l: c)
+            mark[std::abs(l)] = (int8_t)(l > 0 ? 1 : -1);
+
+        size_t   size = c.size();
+        uint64_t sig  = sigs[ci];
+
+        for (int l: {best, -best}) {
+
+            // Copy, strengthening changes the list
+            std::vector<uint32_t> candidates = occ(l);
+
+            for (uint32_t di: candidates) {
+
+                const std::vector<int>& d = clauses[di];
+
+                if (di == ci || removed[di] || d.size() < size || (sig & ~sigs[di]) != 0)
+                    continue;
+
+                steps += d.size();
+
+                size_t found   = 0;
+                int    flipped = 0;
+
+                for (int k: d) {
+
+                    int8_t m = mark[std::abs(k)];
+
+                    if (m == 0)
+                        continue;
+
+                    if (m != (k > 0 ? 1 : -1)) {
+
+                        if (flipped != 0)
+                            break;
+
+                        flipped = k;
+                    }
+
+                    ++found;
+                }
+
+                if (found < size)
+                    continue;
+
+                if (flipped == 0) {
+
+                    remove(di);
+                    ++numSubsumed;
+                } else {
+
+                    strengthen(di, flipped);
+                    ++numStrengthened;
+
+                    queue.push_back(di);
+                }
+            }
+        }
+
+        for (int l: clauses[ci])
+            mark[std::abs(l)] = 0;
+    }
+
+    // Clause without duplicate literals, false if it is a tautology
+    [[nodiscard]] static bool normalize(std::vector<int>& c) {
+
+        std::sort(c.begin(), c.end(), [] (int a, int b) {
+
+            return std::abs(a) != std::abs(b) ? std::abs(a) < std::abs(b) : a < b;
+        });
+
+        c.erase(std::unique(c.begin(), c.end()), c.end());
+
+        for (size_t i = 1; i < c.size(); ++i)
+            if (c[i] == -c[i - 1])
+                return false;
+
+        return true;
+    }
+
+    // Assign l at level 0, with unit propagation over the clauses
+    void fix(int l) {
+
+        std::vector<int> queue = std::vector<int>(1, l);
+
+        while (not queue.empty() && not unsat) {
+
+            int u = queue.back();
+            queue.pop_back();
+
+            auto sign = (int8_t)(u > 0 ? 1 : -1);
+
+            if (fixed[std::abs(u)] == sign)
+                continue;
+
+            if (fixed[std::abs(u)] == -sign) {
+                unsat = true;
+                return;
+            }
+
+            fixed[std::abs(u)] = sign;
+            ++numFixed;
+
+            // Copies, both lists change below
+            for (uint32_t ci: std::vector<uint32_t>(occ(u)))
+                remove(ci);
+
+            for (uint32_t ci: std::vector<uint32_t>(occ(-u))) {
+
+                strengthen(ci, -u);
+
+                if (clauses[ci].size() == 1)
+                    queue.push_back(clauses[ci][0]);
+            }
+        }
+    }
+
+    void fixUnits() {
+
+        for (uint32_t ci = 0; ci < clauses.size() && not unsat; ++ci)
+            if (not removed[ci] && clauses[ci].size() == 1)
+                fix(clauses[ci][0]);
+    }
+
+    [[nodiscard]] inline int8_t probeValue(int l) const {
+
+        int8_t v = fixed[std::abs(l)] != 0 ? fixed[std::abs(l)] : probeVal[std::abs(l)];
+
+        return l > 0 ? v : (int8_t)-v;
+    }
+
+    // Unit propagation of l on top of the fixed variables, false on conflict.
+    // The implied literals are left in probeTrail, see undoProbe().
+    bool probePropagate(int l) {
+
+        probeTrail.clear();
+
+        probeVal[std::abs(l)] = (int8_t)(l > 0 ? 1 : -1);
+        probeTrail.push_back(l);
+
+        for (size_t h = 0; h < probeTrail.size(); ++h)
+            for (uint32_t ci: occurs[litIndex(-probeTrail[h])]) {
+
+                if (removed[ci])
+                    continue;
+
+                const std::vector<int>& c = clauses[ci];
+
+                steps += c.size();
+
+                int  unit  = 0;
+                int  open  = 0;
+                bool sat   = false;
+
+                for (int k: c) {
+
+                    int8_t v = probeValue(k);
+
+                    if (v > 0) {
+                        sat = true;
+                        break;
+                    }
+
+                    if (v == 0) {
+                        unit = k;
+
+                        if (++open > 1)
+                            break;
+                    }
+                }
+
+                if (sat || open > 1)
+                    continue;
+
+                if (open == 0)
+                    return false;
+
+                probeVal[std::abs(unit)] = (int8_t)(unit > 0 ? 1 : -1);
+                probeTrail.push_back(unit);
+            }
+
+        return true;
+    }
+
+    void undoProbe() {
+
+        for (int l: probeTrail)
+            probeVal[std::abs(l)] = 0;
+
+        probeTrail.clear();
+    }
+
+    // Other literal of a live binary clause, 0 otherwise
+    [[nodiscard]] inline int binaryOther(uint32_t ci, int l) const {
+
+        if (removed[ci] || clauses[ci].size() != 2)
+            return 0;
+
+        return clauses[ci][0] == l ? clauses[ci][1] : clauses[ci][0];
+    }
+
+    // Clause ci with every literal replaced by its representative
+    void substitute(uint32_t ci, const std::vector<int>& reprOf) {
+
+        std::vector<int> c = clauses[ci];
+
+        for (int& k: c)
+            if (reprOf[std::abs(k)] != 0)
+                k = k > 0 ? reprOf[std::abs(k)] : -reprOf[std::abs(k)];
+
+        remove(ci);
+
+        if (normalize(c))
+            attach(c);
+    }
+
+    // Propagate both polarities of the roots of the binary implication graph
+    void failedLiterals(const Limits& lim) {
+
+        uint64_t limit = steps + lim.probeLim;
+
+        size_t n = eliminated_.size();
+
+        // Roots: l appears in no binary clause (nothing implies it) but -l does
+        std::vector<int> roots;
+
+        for (int x = 1; x < (int)n; ++x)
+            for (int l: {x, -x}) {
+
+                auto binaries = [this] (int k) {
+
+                    size_t b = 0;
+
+                    for (uint32_t ci: occurs[litIndex(k)])
+                        b += binaryOther(ci, k) != 0;
+
+                    return b;
+                };
+
+                if (not eliminated_[x] && fixed[x] == 0 && binaries(l) == 0 && binaries(-l) > 0)
+                    roots.push_back(l);
+            }
+
+        std::vector<int> implied;
+
+        for (int l: roots) {
+
+            if (steps > limit || unsat)
+                break;
+
+            if (fixed[std::abs(l)] != 0)
+                continue;
+
+            if (not probePropagate(l)) {
+                undoProbe();
+                fix(-l);
+                continue;
+            }
+
+            for (int t: probeTrail)
+                mark[std::abs(t)] = (int8_t)(t > 0 ? 1 : -1);
+
+            implied.assign(probeTrail.begin() + 1, probeTrail.end());
+
+            undoProbe();
+
+            bool ok = probePropagate(-l);
+
+            // Necessary assignments: implied by l and by -l
+            std::vector<int> both;
+
+            if (ok)
+                for (size_t i = 1; i < probeTrail.size(); ++i)
+                    if (mark[std::abs(probeTrail[i])] == (probeTrail[i] > 0 ? 1 : -1))
+                        both.push_back(probeTrail[i]);
+
+            undoProbe();
+
+            mark[std::abs(l)] = 0;
+
+            for (int t: implied)
+                mark[std::abs(t)] = 0;
+
+            if (not ok) {
+                fix(l);
+                continue;
+            }
+
+            for (int t: both)
+                fix(t);
+        }
+    }
+
+    // Replace every literal by the representative of its strongly connected
+    // component in the binary implication graph (a -> b for each clause -a b)
+    void substituteEquivalences() {
+
+        size_t n = eliminated_.size();
+
+        std::vector<int>  index  = std::vector<int>(2 * n, -1);
+        std::vector<int>  low    = std::vector<int>(2 * n, 0);
+        std::vector<char> onStk  = std::vector<char>(2 * n, 0);
+        std::vector<int>  stk;
+
+        // reprOf[x]: literal equivalent to x, 0 when x is its own representative
+        std::vector<int> reprOf = std::vector<int>(n, 0);
+
+        struct Frame {
+            int    lit;
+            size_t next;
+        };
+
+        std::vector<Frame> calls;
+
+        int counter = 0;
+
+        for (int x = 1; x < (int)n && not unsat; ++x)
+            for (int root: {x, -x}) {
+
+                if (index[litIndex(root)] >= 0 || eliminated_[x] || fixed[x] != 0)
+                    continue;
+
+                calls.push_back({root, 0});
+
+                index[litIndex(root)] = low[litIndex(root)] = counter++;
+                stk.push_back(root);
+                onStk[litIndex(root)] = 1;
+
+                // Iterative Tarjan: successors of a are the other literals of the binary clauses with -a
+                while (not calls.empty()) {
+
+                    Frame& f = calls.back();
+
+                    const std::vector<uint32_t>& succ = occurs[litIndex(-f.lit)];
+
+                    bool descended = false;
+
+                    while (f.next < succ.size()) {
+
+                        int b = binaryOther(succ[f.next++], -f.lit);
+
+                        if (b == 0)
+                            continue;
+
+                        steps += 1;
+
+                        if (index[litIndex(b)] < 0) {
+
+                            index[litIndex(b)] = low[litIndex(b)] = counter++;
+                            stk.push_back(b);
+                            onStk[litIndex(b)] = 1;
+
+                            calls.push_back({b, 0});
+                            descended = true;
+                            break;
+                        }
+
+                        if (onStk[litIndex(b)])
+                            low[litIndex(f.lit)] = std::min(low[litIndex(f.lit)], index[litIndex(b)]);
+                    }
+
+                    if (descended)
+                        continue;
+
+                    int a = f.lit;
+
+                    calls.pop_back();
+
+                    if (not calls.empty()) {
+
+                        int parent = calls.back().lit;
+
+                        low[litIndex(parent)] = std::min(low[litIndex(parent)], low[litIndex(a)]);
+                    }
+
+                    if (low[litIndex(a)] != index[litIndex(a)])
+                        continue;
+
+                    // a is the root of a component: pop it
+                    std::vector<int> comp;
+
+                    int b;
+
+                    do {
+                        b = stk.back();
+                        stk.pop_back();
+                        onStk[litIndex(b)] = 0;
+                        comp.push_back(b);
+                    } while (b != a);
+
+                    if (comp.size() < 2)
+                        continue;
+
+                    // The lowest variable represents the others
+                    int rep = comp[0];
+
+                    for (int l: comp) {
+
+                        if (mark[std::abs(l)] != 0)
+                            unsat = true;
+
+                        mark[std::abs(l)] = 1;
+
+                        if (std::abs(l) < std::abs(rep))
+                            rep = l;
+                    }
+
+                    for (int l: comp) {
+
+                        mark[std::abs(l)] = 0;
+
+                        if (std::abs(l) != std::abs(rep))
+                            reprOf[std::abs(l)] = l > 0 ? rep : -rep;
+                    }
+                }
+            }
+
+        if (unsat)
+            return;
+
+        for (int x = 1; x < (int)n; ++x) {
+
+            int r = reprOf[x];
+
+            if (r == 0)
+                continue;
+
+            for (int l: {x, -x})
+                for (uint32_t ci: std::vector<uint32_t>(occ(l)))
+                    substitute(ci, reprOf);
+
+            // x = r: (x or -r) and (-x or r)
+            stack.push_back(x);
+            stack.push_back(-r);
+            stack.push_back(2);
+            stack.push_back(-x);
+            stack.push_back(r);
+            stack.push_back(2);
+
+            eliminated_[x] = 1;
+            ++numSubstituted;
+        }
+    }
+
+    [[nodiscard]] uint64_t cost(int x) {
+
+        return (uint64_t)occ(x).size() * occ(-x).size();
+    }
+
+public:
+
+    explicit Preprocessor(uint64_t numVars = 0)
+            : steps(0), unsat(false), ran(false), numEliminated(0), numSubsumed(0), numStrengthened(0),
+              numSubstituted(0), numFixed(0) {
+
+        occurs      = std::vector<std::vector<uint32_t>>(2 * (numVars + 1));
+        eliminated_ = std::vector<char>(numVars + 1, 0);
+        mark        = std::vector<int8_t>(numVars + 1, 0);
+        touchedMark = std::vector<char>(numVars + 1, 0);
+        costs       = std::vector<uint64_t>(numVars + 1, 0);
+        fixed       = std::vector<int8_t>(numVars + 1, 0);
+        probeVal    = std::vector<int8_t>(numVars + 1, 0);
+    }
+
+    // Duplicate literals are merged and tautologies dropped
+    void addClause(std::vector<int> c) {
+
+        if (not normalize(c))
+            return;
+
+        if (c.empty())
+            unsat = true;
+
+        attach(c);
+    }
+
+    // Subsumption and strengthening over the whole formula, shortest clauses
+    // first. False if the formula turned out unsatisfiable.
+    bool subsume(const Limits& lim) {
+
+        ran = true;
+
+        std::vector<uint32_t> queue;
+
+        for (uint32_t ci = 0; ci < clauses.size(); ++ci)
+            if (not removed[ci])
+                queue.push_back(ci);
+
+        std::stable_sort(queue.begin(), queue.end(), [this] (uint32_t a, uint32_t b) {
+
+            return clauses[a].size() < clauses[b].size();
+        });
+
+        for (size_t q = 0; q < queue.size() && steps <= lim.stepLim && not unsat; ++q)
+            if (not removed[queue[q]])
+                backward(queue[q], queue);
+
+        return not unsat;
+    }
+
+    bool subsume() {
+
+        return subsume(Limits());
+    }
+
+    // Equivalent literal substitution then failed literal probing, after the
+    // unit clauses are propagated. False if the formula turned out unsatisfiable.
+    bool probe(const Limits& lim) {
+
+        ran = true;
+
+        fixUnits();
+
+        if (not unsat)
+            substituteEquivalences();
+
+        // Substitution can produce units
+        if (not unsat)
+            fixUnits();
+
+        if (not unsat)
+            failedLiterals(lim);
+
+        return not unsat;
+    }
+
+    bool probe() {
+
+        return probe(Limits());
+    }
+
+    // Eliminate variables, cheapest first, until nothing changes or the
+    // budget runs out. False if the formula turned out unsatisfiable.
+    bool eliminate(const Limits& lim) {
+
+        ran = true;
+
+        std::vector<int> queue;
+
+        for (int x = 1; x < (int)eliminated_.size(); ++x)
+            queue.push_back(x);
+
+        while (not queue.empty() && not unsat) {
+
+            for (int x: touched)
+                touchedMark[x] = 0;
+
+            touched.clear();
+
+            for (int x: queue)
+                costs[x] = cost(x);
+
+            std::stable_sort(queue.begin(), queue.end(), [this] (int a, int b) { return costs[a] < costs[b]; });
+
+            for (int x: queue) {
+
+                if (eliminated_[x])
+                    continue;
+
+                if (steps > lim.stepLim || unsat)
+                    break;
+
+                tryEliminate(x, lim);
+            }
+
+            if (steps > lim.stepLim)
+                break;
+
+            // Variables whose clauses changed get another chance
+            queue.clear();
+
+            for (int x: touched)
+                if (not eliminated_[x])
+                    queue.push_back(x);
+        }
+
+        return not unsat;
+    }
+
+    bool eliminate() {
+
+        return eliminate(Limits());
+    }
+
+    // Calls f(lits) for every clause of the reduced formula, fixed variables as units
+    template <class F>
+    void forEachClause(F f) const {
+
+        for (size_t i = 0; i < clauses.size(); ++i)
+            if (not removed[i])
+                f(clauses[i]);
+
+        for (int x = 1; x < (int)fixed.size(); ++x)
+            if (fixed[x] != 0)
+                f(std::vector<int>(1, fixed[x] > 0 ? x : -x));
+    }
+
+    // The selected passes, false if the formula turned out unsatisfiable
+    bool run(const Passes& passes) {
+
+        return (not passes.subsume || subsume()) && (not passes.probe || probe()) &&
+               (not passes.elim || eliminate());
+    }
+
+    // Drop the reduced formula once handed over, extend() still works
+    void release() {
+
+        clauses = std::vector<std::vector<int>>();
+        removed = std::vector<char>();
+        sigs    = std::vector<uint64_t>();
+        occurs  = std::vector<std::vector<uint32_t>>();
+    }
+
+    // Assign the eliminated variables. value(var) gives 1, -1 or 0 (unassigned)
+    // for any variable, assign(var, v) sets one.
+    template <class Value, class Assign>
+    void extend(Value value, Assign assign) const {
+
+        size_t i = stack.size();
+
+        while (i > 0) {
+
+            auto size = (size_t)stack[--i];
+
+            i -= size;
+
+            bool sat = false;
+
+            for (size_t k = i; k < i + size && not sat; ++k) {
+
+                int l = stack[k];
+
+                sat = value(std::abs(l)) == (l > 0 ? 1 : -1);
+            }
+
+            // Not satisfied: flip the eliminated variable, stored first
+            if (not sat)
+                assign(std::abs(stack[i]), (int8_t)(stack[i] > 0 ? 1 : -1));
+        }
+    }
+
+    [[nodiscard]] inline bool isEliminated(int var) const {
+
+        return ran && eliminated_[var];
+    }
+
+    [[nodiscard]] inline bool hasRun() const {
+
+        return ran;
+    }
+
+    // What the passes did, one "c <name> <count>" line each
+    void printStats(std::ostream& os) const {
+
+        os << "c eliminated " << numEliminated << std::endl
+           << "c subsumed " << numSubsumed << std::endl
+           << "c strengthened " << numStrengthened << std::endl
+           << "c substituted " << numSubstituted << std::endl
+           << "c fixed " << numFixed << std::endl;
+    }
+};
+
+#define LI_SAT_SOLVER_PREPROCESS_H
+
+#endif //LI_SAT_SOLVER_PREPROCESS_H
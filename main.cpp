@@ -1,416 +1,106 @@
 #include <iostream>
-#include <cstdlib>
 #include <algorithm>
-#include <vector>
-#include <cstdint>
-#include <cmath>
-#include <list>
+#include <memory>
+#include "DPLL/Dpll.h"
+#include "common/Batch.h"
+#include "common/Options.h"
 
 using namespace std;
 
-enum LST : int8_t;
-typedef uint16_t LID;
+int main(int argc, char** argv){
 
-class Lit {
+    Options opts = Options(argc, argv);
 
-private:
+    DpllConfig config;
 
-    LID id;
-    LST st;
+    config.mode     = (DpllConfig::Mode)opts.choice("mode", {"dpll", "lookahead", "sls"}, DpllConfig::DPLL);
+    config.slsFlips = (uint64_t)max(0LL, opts.getInt("sls-flips", 0));
 
-public:
+    config.preprocess.subsume = opts.getInt("subsume", 1) != 0;
+    config.preprocess.probe   = opts.getInt("probe", 1) != 0;
+    config.preprocess.elim    = opts.getInt("elim", 0) != 0;
 
-    inline Lit(LID id, LST st) : id(id), st(st) {}
+    config.phases     = Phases::fromOptions(opts, "none");
+    config.walkEffort = (uint64_t)max(0LL, opts.getInt("walk-effort", 100));
 
-    [[nodiscard]] inline LST state() const {
-        return st;
-    }
-
-    [[nodiscard]] inline LID getId() const {
-        return id;
-    }
-
-    inline void reverse() {
-        st = (LST)(-st);
-    }
-};
-
-typedef vector<Lit> Clause;
-typedef vector<Clause> Problem;
-
-enum LST : int8_t {
-    FALSE = -1,
-    UNDEF = 0,
-    TRUE = 1
-};
-
-uint64_t numClauses;
-LID numVars;
-
-Problem clauses;
-vector<LST> model;
-vector<Lit> modelStack;
-
-vector<vector<uint64_t>> cLitTrue;
-vector<vector<uint64_t>> cLitFalse;
-
-vector<double> value;
-
-uint nextIndex;
-uint level;
-
-uint64_t back = 0;
-
-void setLit(Lit);
-
-void setLit(LID, LST);
-
-LST currentModelValue(Lit);
+    // Batch mode: every file, directory and @list given, on --threads
+    // solvers (0 for one per hardware thread), --timeout seconds each
+    bool   batchMode = opts.getInt("batch", 0) != 0;
+    auto   threads   = (size_t)max(0LL, opts.getInt("threads", 0));
+    double timeout   = max(0.0, opts.getDouble("timeout", 0));
 
-char stateToSymbol(LST);
+    // Search counters as comment lines, before the answer
+    bool stats = opts.getInt("stats", 0) != 0;
 
-int printSat();
+    opts.rejectUnknown();
 
-int printNotSat();
+    if (batchMode) {
 
-void readInput();
+        vector<string> paths;
+        string         error;
 
-void unitClauses();
+        if (not Batch::expand(opts.getPositional(), paths, error)) {
 
-void checkModel();
-
-void backtrack();
-
-bool clauseConflict(const Clause&);
-
-bool propagateGivesConflict () {
-
-    for (; nextIndex < modelStack.size(); ++nextIndex) {
-
-        Lit &l = modelStack[nextIndex];
-
-        switch (l.state()) {
-            case FALSE:
-                for (uint64_t cid: cLitTrue[l.getId()])
-                    if (clauseConflict(clauses[cid]))
-                        return true;
-                break;
-            case UNDEF:
-                break;
-            case TRUE:
-                for (uint64_t cid: cLitFalse[l.getId()])
-                    if (clauseConflict(clauses[cid]))
-                        return true;
-                break;
+            cerr << "c " << error << endl;
+            return 1;
         }
-    }
-
-    return false;
-}
-
-LID nextDecision() {
-
-    vector<double> cuVal = vector<double>(value);
-
-    for (const Clause& c: clauses) {
-
-        double var = 1;
-
-        list<LID> boost = list<LID>();
-
-        for (const Lit& l: c)
-            if (model[l.getId()] != UNDEF)
-                var += 10;
-            else
-                boost.push_back(l.getId());
-
-        for (LID id: boost)
-            cuVal[id] *= var;
-    }
-
-    LID res = 0;
-
-    for (LID id = 1; id <= numVars; ++id)
-        if (model[id] == UNDEF)
-            if (cuVal[res] < cuVal[id])
-                res = id;
-
-    if (res != 0)
-        return res;
-
-    //no UNDEF lit found: terminate program
-
-    checkModel();
-    exit(printSat());
-}
-
-void makeDecision() {
 
-    LID id = nextDecision();
-
-    modelStack.emplace_back(0, UNDEF);
-    ++nextIndex;
-    ++level;
-
-    setLit(id, FALSE);
-}
-
-void initClauseIndex() {
-
-    cLitTrue.resize(numVars + 1, vector<uint64_t>());
-    cLitFalse.resize(numVars + 1, vector<uint64_t>());
-
-    for (uint64_t i = 0; i < clauses.size(); ++i)
-        for (Lit l: clauses[i])
-            switch (l.state()) {
-
-                case FALSE:
-                    cLitFalse[l.getId()].push_back(i);
-                    break;
-                case UNDEF:
-                    break;
-                case TRUE:
-                    cLitTrue[l.getId()].push_back(i);
-                    break;
-            }
-}
+        Batch batch = Batch(paths, threads, timeout);
 
-void compPriority() {
+        vector<unique_ptr<Dpll>> solvers;
 
-    fill(value.begin(), value.end(), 1);
+        for (size_t w = 0; w < batch.getWorkers(); ++w)
+            solvers.push_back(make_unique<Dpll>(config));
 
-    value[0] = -1;
+        batch.run(cout, "backtracks", [&solvers] (size_t w, const string& path, const function<bool()>& expired) {
 
-    auto i = (double)numClauses;
+            Dpll& solver = *solvers[w];
 
-    for (const Clause& c: clauses) {
+            solver.terminateWhen(expired);
+            solver.load(path);
 
-        for (const Lit &l: c)
-            value[l.getId()] += log2(i);
+            Result res = solver.solve();
 
-        for (const Lit& l: c)
-            value[l.getId()] *= 10;
+            return Batch::Outcome{res, solver.getBacktracks()};
+        });
 
-        --i;
+        return 0;
     }
-}
-
-int main(){
-
-    readInput();
-
-    model.resize(numVars + 1,UNDEF);
-
-    nextIndex = 0;
-    level = 0;
-
-    value.resize(numVars + 1);
-
-    initClauseIndex();
-
-    unitClauses();
 
-    compPriority();
+    Dpll solver = Dpll(config);
 
-    while (true) {
+    // DIMACS file, stdin if none
+    try {
 
-        while (propagateGivesConflict()) {
-
-            if (level == 0)
-                exit(printNotSat());
-
-            backtrack();
-        }
-
-        makeDecision();
+        solver.load(opts.getPositional().empty() ? "" : opts.getPositional()[0]);
     }
-}
-
-/////////////////////////////////////////////////////////////////////////////////////////////
-/////////////////////////////////////////////////////////////////////////////////////////////
-
-void unitClauses() {
-
-    // Take care of initial unit clauses, if any
-    for (Clause& c: clauses) {
+    catch (const DimacsReader::Error& e) {
 
-        if (c.size() != 1)
-            continue;
-
-        switch (currentModelValue(c[0])) {
-
-            case FALSE:
-                exit(printNotSat());
-            case UNDEF:
-                setLit(c[0]);
-                break;
-            case TRUE:
-                break;
-        }
-    }
-}
-
-void readInput() {
-
-    // Skip comments
-    char c = cin.get();
-
-    while (c == 'c') {
-
-        while (c != '\n')
-            c = cin.get();
-
-        c = cin.get();
+        cerr << "c " << e.what() << endl;
+        return 1;
     }
 
-    // Read "cnf numVars numClauses"
-    string aux;
-    cin >> aux >> numVars >> numClauses;
-
-    clauses.resize(numClauses);
-
-    // Read clauses
-    for (uint i = 0; i < numClauses; ++i) {
+    Result res = solver.solve();
 
-        int lit;
+    if (stats) {
 
-        while (cin >> lit and lit != 0) {
+        cout << "c conflicts " << solver.getBacktracks() << endl
+             << "c decisions " << solver.getDecisions() << endl
+             << "c propagations " << solver.getPropagations() << endl;
 
-            if (lit > 0)
-                clauses[i].emplace_back(lit, TRUE);
-            else
-                clauses[i].emplace_back(-lit, FALSE);
-        }
+        solver.preprocessor().printStats(cout);
     }
-}
 
-char stateToSymbol(LST st) {
+    switch (res) {
 
-    switch (st) {
-        case FALSE:
-            return '-';
-        case TRUE:
-            return '+';
-        case UNDEF:
-            return ' ';
+        case SATISFIABLE:
+            cout << "SATISFIABLE" << ' ' << solver.getBacktracks() << endl;
+            return 20;
+        case UNSATISFIABLE:
+            cout << "UNSATISFIABLE" << ' ' << solver.getBacktracks() << endl;
+            return 10;
         default:
-            return '?';
+            cout << "UNKNOWN" << ' ' << solver.getBacktracks() << endl;
+            return 0;
     }
 }
-
-void printErrorTerm(const Clause& c) {
-
-    cout << "Error in model, clause is not satisfied:";
-
-    for (Lit l: c)
-        cout << "[" << stateToSymbol(l.state()) << "]" << l.getId() << " ";
-
-    cout << endl;
-    exit(1);
-}
-
-bool someLitTrue(const Clause& c) {
-
-    return any_of(c.begin(), c.end(), [](Lit l) -> bool {
-        return currentModelValue(l) == TRUE;
-    });
-}
-
-void checkModel() {
-
-    for (Clause& c: clauses)
-        if (not someLitTrue(c))
-            printErrorTerm(c);
-}
-
-int printSat() {
-
-    cout << "SATISFIABLE" << ' ' << back << endl;
-    return 20;
-}
-
-int printNotSat() {
-
-    cout << "UNSATISFIABLE" << ' ' << back << endl;
-    return 10;
-}
-
-LST currentModelValue(Lit l) {
-
-    if (model[l.getId()] == UNDEF)
-        return UNDEF;
-
-    if (model[l.getId()] == l.state())
-        return TRUE;
-
-    return FALSE;
-}
-
-void backtrack() {
-
-    Lit l = Lit(0, UNDEF);
-
-    for (auto it = modelStack.rbegin();
-         it != modelStack.rend();
-         ++it, modelStack.pop_back()
-            ) {
-
-        if (it->getId() == 0)
-            break;
-
-        l = *it;
-        model[l.getId()] = UNDEF;
-    }
-
-    modelStack.pop_back();
-    --level;
-    nextIndex = modelStack.size();
-
-    l.reverse();
-    setLit(l);
-
-    ++back;
-}
-
-void setLit(Lit l) {
-
-    modelStack.push_back(l);
-
-    model[l.getId()] = l.state();
-}
-
-void setLit(LID id, LST st) {
-
-    modelStack.emplace_back(id, st);
-
-    model[id] = st;
-}
-
-bool clauseConflict(const Clause& c) {
-
-    bool one = false;
-
-    Lit lastLitUndef = Lit(0, UNDEF);
-
-    for (Lit l: c)
-        switch (currentModelValue(l)) {
-            case FALSE:
-                break;
-            case UNDEF:
-
-                if (one)
-                    return false;
-                one = true;
-
-                lastLitUndef = l;
-                break;
-            case TRUE:
-                return false;
-        }
-
-    if (not one)
-        return true;
-
-    setLit(lastLitUndef);
-    return false;
-}
\ No newline at end of file